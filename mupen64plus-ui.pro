@@ -3,7 +3,7 @@ QT       += core network xml sql
 lessThan(QT_MAJOR_VERSION, 5) {
     QT   += gui
 } else {
-    QT   += widgets
+    QT   += widgets concurrent
 }
 
 macx {
@@ -26,6 +26,8 @@ SOURCES += src/main.cpp \
     src/plugin.cpp \
     src/sdl.cpp \
     src/settings.cpp \
+    src/settingsstore.cpp \
+    src/stallwatchdog.cpp \
     src/config/configcontrolcollection.cpp \
     src/config/keyspec.cpp \
     src/dialogs/aboutguidialog.cpp \
@@ -43,13 +45,28 @@ SOURCES += src/main.cpp \
     src/emulation/glwindow.cpp \
     src/emulation/vidext.cpp \
     src/osal/osal_dynamiclib.c \
+    src/roms/covercache.cpp \
+    src/roms/coverloader.cpp \
+    src/roms/coverscaler.cpp \
+    src/roms/rombitmap.cpp \
     src/roms/romcollection.cpp \
+    src/roms/romcollectionmodel.cpp \
+    src/roms/romfacetindex.cpp \
+    src/roms/romfield.cpp \
+    src/roms/romfiltermodel.cpp \
+    src/roms/rommetadata.cpp \
+    src/roms/romsearchindex.cpp \
+    src/roms/romtablemodel.cpp \
     src/roms/thegamesdbscraper.cpp \
+    src/roms/thumbnailpack.cpp \
+    src/roms/titlematcher.cpp \
+    src/views/facetpanel.cpp \
     src/views/gridview.cpp \
     src/views/listview.cpp \
     src/views/tableview.cpp \
-    src/views/widgets/clickablewidget.cpp \
-    src/views/widgets/treewidgetitem.cpp
+    src/views/delegates/griddelegate.cpp \
+    src/views/delegates/listdelegate.cpp \
+    src/views/delegates/tabledelegate.cpp
 
 HEADERS += src/global.h \
     src/cheatparse.h \
@@ -60,6 +77,8 @@ HEADERS += src/global.h \
     src/plugin.h \
     src/sdl.h \
     src/settings.h \
+    src/settingsstore.h \
+    src/stallwatchdog.h \
     src/config/configcontrolcollection.h \
     src/config/keyspec.h \
     src/dialogs/aboutguidialog.h \
@@ -77,13 +96,29 @@ HEADERS += src/global.h \
     src/emulation/glwindow.h \
     src/emulation/vidext.h \
     src/osal/osal_dynamiclib.h \
+    src/roms/covercache.h \
+    src/roms/coverloader.h \
+    src/roms/coverscaler.h \
+    src/roms/parallelsort.h \
+    src/roms/rombitmap.h \
     src/roms/romcollection.h \
+    src/roms/romcollectionmodel.h \
+    src/roms/romfacetindex.h \
+    src/roms/romfield.h \
+    src/roms/romfiltermodel.h \
+    src/roms/rommetadata.h \
+    src/roms/romsearchindex.h \
+    src/roms/romtablemodel.h \
     src/roms/thegamesdbscraper.h \
+    src/roms/thumbnailpack.h \
+    src/roms/titlematcher.h \
+    src/views/facetpanel.h \
     src/views/gridview.h \
     src/views/listview.h \
     src/views/tableview.h \
-    src/views/widgets/clickablewidget.h \
-    src/views/widgets/treewidgetitem.h
+    src/views/delegates/griddelegate.h \
+    src/views/delegates/listdelegate.h \
+    src/views/delegates/tabledelegate.h
 
 RESOURCES += resources/mupen64plus.qrc
 
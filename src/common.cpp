@@ -33,16 +33,21 @@
 #include "common.h"
 #include "error.h"
 #include "global.h"
+#include "roms/romfield.h"
 
 #include <QColor>
 #include <QDir>
 #include <QEventLoop>
 #include <QFile>
+#include <QImage>
 #include <QLocale>
 #include <QSize>
 #include <QApplication>
+#include <QPainter>
 #include <QPalette>
+#include <QPixmapCache>
 #include <QStyle>
+#include <QVector>
 
 #if QT_VERSION >= 0x050000
 #include <quazip5/quazip.h>
@@ -63,7 +68,7 @@
 
 void setTheme()
 {
-    return setTheme(SETTINGS.value("theme", "Default").toString());
+    return setTheme(CACHED_SETTINGS.theme);
 }
 
 
@@ -172,37 +177,12 @@ QString getDefaultLanguage()
 }
 
 
-int getDefaultWidth(QString id, int imageWidth)
-{
-    if (id == "Overview")
-        return 400;
-    else if (id == "GoodName" || id.left(8) == "Filename" || id == "Game Title")
-        return 300;
-    else if (id == "MD5")
-        return 250;
-    else if (id == "Internal Name" || id == "Publisher" || id == "Developer")
-        return 200;
-    else if (id == "ESRB" || id == "Genre")
-        return 150;
-    else if (id == "Save Type" || id == "Release Date")
-        return 100;
-    else if (id == "CRC1" || id == "CRC2")
-        return 90;
-    else if (id == "Size" || id == "Rumble" || id == "Players" || id == "Rating")
-        return 75;
-    else if (id == "Game Cover")
-        return imageWidth;
-    else
-        return 100;
-}
-
-
 int getGridSize(QString which)
 {
-    QString size = SETTINGS.value("Grid/imagesize","Medium").toString();
+    QString size = CACHED_SETTINGS.gridImageSize;
 
     if (which == "height") {
-        if (SETTINGS.value("Grid/label", "true").toString() == "true") {
+        if (CACHED_SETTINGS.gridLabel) {
             if (size == "Extra Small") return 65;
             if (size == "Small")       return 90;
             if (size == "Medium")      return 145;
@@ -238,7 +218,14 @@ int getGridSize(QString which)
 
 QSize getImageSize(QString view)
 {
-    QString size = SETTINGS.value(view+"/imagesize","Medium").toString();
+    QString size = "Medium";
+
+    if (view == "Table")
+        size = CACHED_SETTINGS.tableImageSize;
+    else if (view == "Grid")
+        size = CACHED_SETTINGS.gridImageSize;
+    else if (view == "List")
+        size = CACHED_SETTINGS.listImageSize;
 
     if (view == "Table") {
         if (size == "Extra Small") return QSize(33, 24);
@@ -262,101 +249,101 @@ QSize getImageSize(QString view)
 
 QString getRomInfo(QString identifier, const Rom *rom, bool removeWarn, bool sort)
 {
-    QString text = "";
-
-    if (identifier == "GoodName")
-        text = rom->goodName;
-    else if (identifier == "Filename")
-        text = rom->baseName;
-    else if (identifier == "Filename (extension)")
-        text = rom->fileName;
-    else if (identifier == "Zip File")
-        text = rom->zipFile;
-    else if (identifier == "Internal Name")
-        text = rom->internalName;
-    else if (identifier == "Size")
-        text = rom->size;
-    else if (identifier == "MD5")
-        text = rom->romMD5.toLower();
-    else if (identifier == "CRC1")
-        text = rom->CRC1.toLower();
-    else if (identifier == "CRC2")
-        text = rom->CRC2.toLower();
-    else if (identifier == "Players")
-        text = rom->players;
-    else if (identifier == "Rumble")
-        text = rom->rumble;
-    else if (identifier == "Save Type")
-        text = rom->saveType;
-    else if (identifier == "Game Title")
-        text = rom->gameTitle;
-    else if (identifier == "Release Date")
-        text = rom->releaseDate;
-    else if (identifier == "Overview")
-        text = rom->overview;
-    else if (identifier == "ESRB")
-        text = rom->esrb;
-    else if (identifier == "Genre")
-        text = rom->genre;
-    else if (identifier == "Publisher")
-        text = rom->publisher;
-    else if (identifier == "Developer")
-        text = rom->developer;
-    else if (identifier == "Rating")
-        text = rom->rating;
-
-    if (!removeWarn)
-        return text;
-    else if (text == getTranslation("Unknown ROM") ||
-             text == getTranslation("Requires catalog file") ||
-             text == getTranslation("Not found")) {
-        if (sort)
-            return "ZZZ"; //Sort warnings at the end
-        else
-            return "";
-    } else
-        return text;
+    return getRomInfo(getRomFieldId(identifier), rom, removeWarn, sort);
 }
 
 
-QGraphicsDropShadowEffect *getShadow(bool active)
+static void blurLine(QRgb *line, int count, int stride, int radius, QVector<QRgb> &buffer)
 {
-    QGraphicsDropShadowEffect *shadow = new QGraphicsDropShadowEffect;
+    //Box blur with a running sum; pixels outside the image count as transparent
+    buffer.resize(count);
+    for (int i = 0; i < count; i++)
+        buffer[i] = line[i * stride];
+
+    int window = radius * 2 + 1;
+    int a = 0, r = 0, g = 0, b = 0;
+    for (int i = 0; i <= radius && i < count; i++) {
+        a += qAlpha(buffer[i]); r += qRed(buffer[i]); g += qGreen(buffer[i]); b += qBlue(buffer[i]);
+    }
 
-    if (active) {
-        shadow->setBlurRadius(25.0);
-        shadow->setColor(getColor(SETTINGS.value("Grid/activecolor","Cyan").toString(), 255));
-        shadow->setOffset(0);
-    } else {
-        shadow->setBlurRadius(10.0);
-        shadow->setColor(getColor(SETTINGS.value("Grid/inactivecolor","Black").toString(), 200));
-        shadow->setOffset(0);
+    for (int i = 0; i < count; i++) {
+        line[i * stride] = qRgba(r / window, g / window, b / window, a / window);
+
+        int next = i + radius + 1;
+        if (next < count) {
+            a += qAlpha(buffer[next]); r += qRed(buffer[next]); g += qGreen(buffer[next]); b += qBlue(buffer[next]);
+        }
+
+        int last = i - radius;
+        if (last >= 0) {
+            a -= qAlpha(buffer[last]); r -= qRed(buffer[last]); g -= qGreen(buffer[last]); b -= qBlue(buffer[last]);
+        }
     }
+}
 
-    return shadow;
+
+static void blurImage(QImage &image, int radius)
+{
+    //Three box passes come close to a gaussian reaching radius pixels out
+    int boxRadius = qMax(1, radius / 3);
+    int width = image.width();
+    int height = image.height();
+    QRgb *pixels = reinterpret_cast<QRgb*>(image.bits());
+    int stride = image.bytesPerLine() / 4;
+    QVector<QRgb> buffer;
+
+    for (int pass = 0; pass < 3; pass++) {
+        for (int y = 0; y < height; y++)
+            blurLine(pixels + y * stride, width, 1, boxRadius, buffer);
+        for (int x = 0; x < width; x++)
+            blurLine(pixels + x, height, stride, boxRadius, buffer);
+    }
 }
 
 
-int getTableDataIndexFromName(QString infoName)
+QPixmap getShadow(bool active)
 {
-    if (infoName == "fileName")
-        return 0;
-    else if (infoName == "dirName")
-        return 1;
-    else if (infoName == "search")
-        return 2;
-    else if (infoName == "romMD5")
-        return 3;
-    else if (infoName == "zipFile")
-        return 4;
+    //Nine-slice sprite of a blurred square: corners and edges are each 2 * radius
+    //wide and the single centre pixel is solid, so it can be stretched to any cover
+    int radius = getShadowRadius(active);
+    QColor color = active ? getColor(CACHED_SETTINGS.gridActiveColor, 255)
+                          : getColor(CACHED_SETTINGS.gridInactiveColor, 200);
+    QString key = "shadow/" + QString::number(radius) + "/" + color.name() + "/" + QString::number(color.alpha());
+
+    QPixmap shadow;
+    if (QPixmapCache::find(key, &shadow))
+        return shadow;
+
+    int side = radius * 4 + 1;
+    QImage image(side, side, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.fillRect(radius, radius, radius * 2 + 1, radius * 2 + 1, Qt::black);
+    painter.end();
+
+    blurImage(image, radius);
+
+    painter.begin(&image);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+    painter.fillRect(image.rect(), color);
+    painter.end();
+
+    shadow = QPixmap::fromImage(image);
+    QPixmapCache::insert(key, shadow);
+    return shadow;
+}
 
-    return 0;
+
+int getShadowRadius(bool active)
+{
+    return active ? 25 : 10;
 }
 
 
 int getTextSize()
 {
-    QString size = SETTINGS.value("List/textsize","Medium").toString();
+    QString size = CACHED_SETTINGS.listTextSize;
 
     if (size == "Extra Small") return 7;
     if (size == "Small")       return 9;
@@ -369,27 +356,9 @@ int getTextSize()
 
 QString getTranslation(QString text)
 {
-    if (text == "GoodName")                     return QObject::tr("GoodName");
-    else if (text == "Filename")                return QObject::tr("Filename");
-    else if (text == "Filename (extension)")    return QObject::tr("Filename (extension)");
-    else if (text == "Zip File")                return QObject::tr("Zip File");
-    else if (text == "Internal Name")           return QObject::tr("Internal Name");
-    else if (text == "Size")                    return QObject::tr("Size");
-    else if (text == "MD5")                     return QObject::tr("MD5");
-    else if (text == "CRC1")                    return QObject::tr("CRC1");
-    else if (text == "CRC2")                    return QObject::tr("CRC2");
-    else if (text == "Players")                 return QObject::tr("Players");
-    else if (text == "Rumble")                  return QObject::tr("Rumble");
-    else if (text == "Save Type")               return QObject::tr("Save Type");
-    else if (text == "Game Title")              return QObject::tr("Game Title");
-    else if (text == "Release Date")            return QObject::tr("Release Date");
-    else if (text == "Overview")                return QObject::tr("Overview");
-    else if (text == "ESRB")                    return QObject::tr("ESRB");
-    else if (text == "Genre")                   return QObject::tr("Genre");
-    else if (text == "Publisher")               return QObject::tr("Publisher");
-    else if (text == "Developer")               return QObject::tr("Developer");
-    else if (text == "Rating")                  return QObject::tr("Rating");
-    else if (text == "Game Cover")              return QObject::tr("Game Cover");
+    RomFieldId field = getRomFieldId(text);
+
+    if (field != InvalidField)                  return getRomFieldTitle(field);
     else if (text == "Unknown ROM")             return QObject::tr("Unknown ROM");
     else if (text == "Requires catalog file")   return QObject::tr("Requires catalog file");
     else if (text == "Not found")               return QObject::tr("Not found");
@@ -420,51 +389,6 @@ QStringList getZippedFiles(QString completeFileName)
 }
 
 
-bool romSorter(const Rom &firstRom, const Rom &lastRom)
-{
-    QString sort, direction;
-
-    QString layout = SETTINGS.value("View/layout", "None").toString();
-    if (layout == "grid") {
-        sort = SETTINGS.value("Grid/sort", "Filename").toString();
-        direction = SETTINGS.value("Grid/sortdirection", "ascending").toString();
-    } else if (layout == "list") {
-        sort = SETTINGS.value("List/sort", "Filename").toString();
-        direction = SETTINGS.value("List/sortdirection", "ascending").toString();
-    } else //just return sort by filename
-        return firstRom.fileName < lastRom.fileName;
-
-
-    QString sortFirst = "", sortLast = "";
-
-    if (sort == "Size") {
-        int firstSize = firstRom.sortSize;
-        int lastSize = lastRom.sortSize;
-
-        if (direction == "descending")
-            return firstSize > lastSize;
-        else
-            return firstSize < lastSize;
-    } else if (sort == "Release Date") {
-        sortFirst = firstRom.sortDate;
-        sortLast = lastRom.sortDate;
-    } else {
-        sortFirst = getRomInfo(sort, &firstRom, true, true);
-        sortLast = getRomInfo(sort, &lastRom, true, true);
-    }
-
-    if (sortFirst == sortLast) { //Equal so sort on filename
-        sortFirst = firstRom.fileName;
-        sortLast = lastRom.fileName;
-    }
-
-    if (direction == "descending")
-        return sortFirst > sortLast;
-    else
-        return sortFirst < sortLast;
-}
-
-
 void readRomFile(QByteArray &romData,
         const QString &romFileName,
         const QString &zipFileName)
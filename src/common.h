@@ -33,7 +33,6 @@
 #ifndef COMMON_H
 #define COMMON_H
 
-#include <QGraphicsDropShadowEffect>
 #include <QString>
 #include <QPixmap>
 #include <QObject>
@@ -71,16 +70,10 @@ struct Rom {
     QString developer;
     QString rating;
 
-    QPixmap image;
-
     int count;
-    bool imageExists;
 };
 
-bool romSorter(const Rom &firstRom, const Rom &lastRom);
-int getDefaultWidth(QString id, int imageWidth);
 int getGridSize(QString which);
-int getTableDataIndexFromName(QString infoName);
 int getTextSize();
 
 void setTheme();
@@ -90,7 +83,8 @@ QStringList getZippedFiles(QString completeFileName);
 QColor getColor(QString color, int transparency = 255);
 QString getDefaultLanguage();
 QString getTranslation(QString text);
-QGraphicsDropShadowEffect *getShadow(bool active);
+QPixmap getShadow(bool active);
+int getShadowRadius(bool active);
 QSize getImageSize(QString view);
 QString getCacheLocation();
 QString getDataLocation();
@@ -33,9 +33,11 @@
 #include "logdialog.h"
 #include "../error.h"
 #include "../global.h"
+#include "../stallwatchdog.h"
 
 #include <QDialogButtonBox>
 #include <QGridLayout>
+#include <QTabWidget>
 #include <QTextEdit>
 
 #if QT_VERSION >= 0x050200
@@ -83,10 +85,20 @@ LogDialog::LogDialog(QWidget *parent)
     }
     logArea->setHtml(output);
 
+    stallArea = new QTextEdit(this);
+    stallArea->setWordWrapMode(QTextOption::NoWrap);
+    stallArea->setReadOnly(true);
+    stallArea->setFont(font);
+    stallArea->setPlainText(StallWatchdog::instance()->getReport());
+
+    logTabs = new QTabWidget(this);
+    logTabs->addTab(logArea, tr("Log"));
+    logTabs->addTab(stallArea, tr("Stalls"));
+
     logButtonBox = new QDialogButtonBox(Qt::Horizontal, this);
     logButtonBox->addButton(tr("Close"), QDialogButtonBox::AcceptRole);
 
-    logLayout->addWidget(logArea, 0, 0);
+    logLayout->addWidget(logTabs, 0, 0);
     logLayout->addWidget(logButtonBox, 1, 0);
 
     connect(logButtonBox, SIGNAL(accepted()), this, SLOT(close()));
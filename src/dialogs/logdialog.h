@@ -36,6 +36,7 @@
 
 class QDialogButtonBox;
 class QGridLayout;
+class QTabWidget;
 class QTextEdit;
 
 
@@ -48,7 +49,9 @@ public:
 private:
     QDialogButtonBox *logButtonBox;
     QGridLayout *logLayout;
+    QTabWidget *logTabs;
     QTextEdit *logArea;
+    QTextEdit *stallArea;
 };
 
 #endif // LOGDIALOG_H
@@ -357,6 +357,9 @@ SettingsDialog::SettingsDialog(QWidget *parent, int activeTab) : QDialog(parent)
     QString theme = SETTINGS.value("theme").toString();
     ui->themeBox->setCurrentText(theme);
 
+    if (SETTINGS.value("Other/gamingmode", "").toString() == "true")
+        ui->gamingModeOption->setChecked(true);
+
     connect(ui->downloadOption, SIGNAL(toggled(bool)), this, SLOT(toggleDownload(bool)));
     connect(ui->downloadOption, SIGNAL(toggled(bool)), this, SLOT(populateTableAndListTab(bool)));
     connect(ui->languageBox, SIGNAL(currentIndexChanged(int)), this, SLOT(updateLanguageInfo()));
@@ -599,6 +602,11 @@ void SettingsDialog::editSettings()
     setTheme(ui->themeBox->currentText());
     SETTINGS.setValue("language", ui->languageBox->itemData(ui->languageBox->currentIndex()));
 
+    if (ui->gamingModeOption->isChecked())
+        SETTINGS.setValue("Other/gamingmode", true);
+    else
+        SETTINGS.setValue("Other/gamingmode", "");
+
     ConfigSaveSection("Core");
     ConfigSaveSection("Video-General");
     close();
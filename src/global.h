@@ -34,6 +34,7 @@
 #define GLOBAL_H
 
 #include "common.h"
+#include "settingsstore.h"
 
 #include <QObject>
 #include <QSettings>
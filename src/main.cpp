@@ -34,6 +34,7 @@
 #include "common.h"
 #include "mainwindow.h"
 #include "core.h"
+#include "stallwatchdog.h"
 #include "emulation/emulation.h"
 
 #include <QApplication>
@@ -67,6 +68,8 @@ int main(int argc, char *argv[])
 
     setTheme();
 
+    StallWatchdog::instance()->start();
+
     MainWindow window;
 
     QString maximized = SETTINGS.value("Geometry/maximized", "").toString();
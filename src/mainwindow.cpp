@@ -37,6 +37,7 @@
 #include "error.h"
 #include "core.h"
 #include "settings.h"
+#include "stallwatchdog.h"
 
 #include "dialogs/aboutguidialog.h"
 #include "dialogs/cheatdialog.h"
@@ -50,9 +51,15 @@
 #include "emulation/glwindow.h"
 #include "emulation/emulation.h"
 
+#include "roms/covercache.h"
+#include "roms/coverloader.h"
 #include "roms/romcollection.h"
+#include "roms/romcollectionmodel.h"
+#include "roms/romfiltermodel.h"
+#include "roms/rommetadata.h"
 #include "roms/thegamesdbscraper.h"
 
+#include "views/facetpanel.h"
 #include "views/gridview.h"
 #include "views/listview.h"
 #include "views/tableview.h"
@@ -64,10 +71,14 @@
 #include <QDialogButtonBox>
 #include <QFileDialog>
 #include <QGridLayout>
+#include <QHBoxLayout>
 #include <QLabel>
+#include <QLineEdit>
 #include <QListWidget>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QPixmapCache>
+#include <QScrollBar>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QCoreApplication>
@@ -85,6 +96,8 @@ MainWindow::MainWindow(QWidget *parent)
     setWindowIcon(QIcon(":/images/"+AppNameLower+".png"));
     installEventFilter(this);
 
+    libraryReleased = false;
+
     autoloadSettings();
 
     romCollection = new RomCollection(QStringList() << "*.z64" << "*.v64" << "*.n64" << "*.zip",
@@ -103,6 +116,9 @@ MainWindow::MainWindow(QWidget *parent)
             this, SLOT(destroyGlWindow()),
             Qt::BlockingQueuedConnection);
     connect(&emulation, SIGNAL(finished()), this, SLOT(enableButtons()));
+    // Gaming mode, not blocking so the game doesn't wait for it
+    connect(&emulation, SIGNAL(started()), this, SLOT(releaseLibrary()));
+    connect(&emulation, SIGNAL(finished()), this, SLOT(restoreLibrary()));
     connect(&emulation, SIGNAL(createGlWindow(QSurfaceFormat*)),
             this, SLOT(createGlWindow(QSurfaceFormat*)),
             Qt::BlockingQueuedConnection);
@@ -111,7 +127,9 @@ MainWindow::MainWindow(QWidget *parent)
             Qt::BlockingQueuedConnection);
 
     connect(romCollection, SIGNAL(updateStarted(bool)), this, SLOT(disableViews(bool)));
-    connect(romCollection, SIGNAL(romAdded(Rom*, int)), this, SLOT(addToView(Rom*, int)));
+    // Keep fetching until the view can scroll
+    connect(romCollection->getModel(), SIGNAL(rowsInserted(QModelIndex, int, int)),
+            this, SLOT(fetchMoreRoms()), Qt::QueuedConnection);
     connect(romCollection, SIGNAL(updateEnded(int, bool)), this, SLOT(enableViews(int, bool)));
 
     romCollection->cachedRoms(false, true);
@@ -132,11 +150,16 @@ MainWindow::MainWindow(QWidget *parent)
 
     mainLayout = new QVBoxLayout(mainWidget);
 
-    mainLayout->addWidget(emptyView);
-    mainLayout->addWidget(tableView);
-    mainLayout->addWidget(gridView);
-    mainLayout->addWidget(listView);
-    mainLayout->addWidget(disabledView);
+    viewLayout = new QHBoxLayout();
+    viewLayout->addWidget(facetPanel);
+    viewLayout->addWidget(emptyView);
+    viewLayout->addWidget(tableView);
+    viewLayout->addWidget(gridView);
+    viewLayout->addWidget(listView);
+    viewLayout->addWidget(disabledView);
+
+    mainLayout->addWidget(searchBar);
+    mainLayout->addLayout(viewLayout);
 
     mainLayout->setMargin(0);
 
@@ -223,20 +246,6 @@ void MainWindow::resizeWindow(int width, int height)
 }
 
 
-void MainWindow::addToView(Rom *currentRom, int count)
-{
-    QString visibleLayout = SETTINGS.value("View/layout", "table").toString();
-
-    if (visibleLayout == "table") {
-        tableView->addToTableView(currentRom);
-    } else if (visibleLayout == "grid") {
-        gridView->addToGridView(currentRom, count, false);
-    } else if (visibleLayout == "list") {
-        listView->addToListView(currentRom, count, false);
-    }
-}
-
-
 void MainWindow::autoloadSettings()
 {
     QString pluginPath = SETTINGS.value("Paths/plugins", "").toString();
@@ -398,6 +407,7 @@ void MainWindow::createMenu()
     refreshAction = fileMenu->addAction(tr("&Refresh List"));
     downloadAction = fileMenu->addAction(tr("&Download/Update Info..."));
     deleteAction = fileMenu->addAction(tr("D&elete Current Info..."));
+    importAction = fileMenu->addAction(tr("&Import Info..."));
 #ifndef Q_OS_OSX
     // OSX does not show the quit action so the separator is unneeded
     fileMenu->addSeparator();
@@ -415,6 +425,7 @@ void MainWindow::createMenu()
 
     downloadAction->setEnabled(false);
     deleteAction->setEnabled(false);
+    importAction->setEnabled(CACHED_SETTINGS.downloadInfo);
 
     menuBar->addMenu(fileMenu);
 
@@ -422,6 +433,7 @@ void MainWindow::createMenu()
     connect(refreshAction, SIGNAL(triggered()), romCollection, SLOT(addRoms()));
     connect(downloadAction, SIGNAL(triggered()), this, SLOT(openDownloader()));
     connect(deleteAction, SIGNAL(triggered()), this, SLOT(openDeleteDialog()));
+    connect(importAction, SIGNAL(triggered()), this, SLOT(openImport()));
     connect(quitAction, SIGNAL(triggered()), this, SLOT(close()));
 
 
@@ -529,7 +541,7 @@ void MainWindow::createMenu()
             << (QStringList() << tr("Grid View")  << "grid")
             << (QStringList() << tr("List View")  << "list");
 
-    QString layoutValue = SETTINGS.value("View/layout", "table").toString();
+    QString layoutValue = CACHED_SETTINGS.viewLayout;
 
     foreach (QStringList layoutName, layouts) {
         QAction *layoutItem = layoutMenu->addAction(layoutName.at(0));
@@ -547,6 +559,15 @@ void MainWindow::createMenu()
 
     viewMenu->addSeparator();
 
+    searchAction = viewMenu->addAction(tr("&Search"));
+    searchAction->setShortcut(QKeySequence::Find);
+    menuEnable << searchAction;
+
+    facetAction = viewMenu->addAction(tr("Show &Filters"));
+    facetAction->setCheckable(true);
+    facetAction->setChecked(CACHED_SETTINGS.showFacets);
+    menuEnable << facetAction;
+
 #if QT_VERSION >= 0x050000
     // OSX El Capitan adds it's own full-screen option
     if (QSysInfo::macVersion() < QSysInfo::MV_ELCAPITAN
@@ -568,6 +589,8 @@ void MainWindow::createMenu()
 
     connect(layoutGroup, SIGNAL(triggered(QAction*)), this, SLOT(updateLayoutSetting()));
     connect(fullScreenAction, SIGNAL(triggered()), this, SLOT(updateFullScreenMode()));
+    connect(searchAction, SIGNAL(triggered()), this, SLOT(focusSearchBar()));
+    connect(facetAction, SIGNAL(triggered()), this, SLOT(updateFacetSetting()));
     connect(logAction, SIGNAL(triggered()), this, SLOT(openLog()));
 
 
@@ -587,6 +610,7 @@ void MainWindow::createMenu()
                << downloadAction
                << pluginsAction
                << deleteAction
+               << importAction
                << configureAction
                << configureGameAction
                << editorAction;
@@ -631,22 +655,53 @@ void MainWindow::createRomView()
     emptyView->setLayout(emptyLayout);
 
 
+    // All views render the same model, so switching between them doesn't touch the database
+    RomCollectionModel *model = romCollection->getModel();
+
+
+    // Create search bar, which filters the model without rebuilding the views
+    searchBar = new QLineEdit(this);
+    searchBar->setPlaceholderText(tr("Search"));
+#if QT_VERSION >= 0x050200
+    searchBar->setClearButtonEnabled(true);
+#endif
+    searchBar->setHidden(CACHED_SETTINGS.viewLayout == "none");
+    connect(searchBar, SIGNAL(textChanged(QString)), model, SLOT(setFilter(QString)));
+
+
+    // Create facet panel for filtering on scraped metadata
+    facetPanel = new FacetPanel(this);
+    facetPanel->setModel(model);
+    facetPanel->setHidden(!CACHED_SETTINGS.showFacets || CACHED_SETTINGS.viewLayout == "none");
+
+
     // Create table view
     tableView = new TableView(this);
+    tableView->setCollectionModel(model);
     connect(tableView, SIGNAL(clicked(QModelIndex)), this, SLOT(enableButtons()));
     connect(tableView, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(launchRomFromTable()));
     connect(tableView, SIGNAL(tableActive()), this, SLOT(enableButtons()));
     connect(tableView, SIGNAL(enterPressed()), this, SLOT(launchRomFromTable()));
+    connect(tableView, SIGNAL(sortChanged()), this, SLOT(tableSortChanged()), Qt::QueuedConnection);
+    connect(tableView->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(fetchMoreRoms()));
 
 
     // Create grid view
     gridView = new GridView(this);
+    gridView->setCollectionModel(model);
     connect(gridView, SIGNAL(gridItemSelected(bool)), this, SLOT(toggleMenus(bool)));
+    connect(gridView, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(launchRomFromGrid()));
+    connect(gridView, SIGNAL(enterPressed()), this, SLOT(launchRomFromGrid()));
+    connect(gridView->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(fetchMoreRoms()));
 
 
     // Create list view
     listView = new ListView(this);
+    listView->setCollectionModel(model);
     connect(listView, SIGNAL(listItemSelected(bool)), this, SLOT(toggleMenus(bool)));
+    connect(listView, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(launchRomFromList()));
+    connect(listView, SIGNAL(enterPressed()), this, SLOT(launchRomFromList()));
+    connect(listView->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(fetchMoreRoms()));
 
 
     // Create disabled view
@@ -678,7 +733,7 @@ void MainWindow::disableButtons()
 
 void MainWindow::disableViews(bool imageUpdated)
 {
-    QString visibleLayout = SETTINGS.value("View/layout", "table").toString();
+    QString visibleLayout = CACHED_SETTINGS.viewLayout;
 
     // Save position in current layout
     if (visibleLayout == "table") {
@@ -690,7 +745,6 @@ void MainWindow::disableViews(bool imageUpdated)
     }
 
     resetLayouts(imageUpdated);
-    tableView->clear();
 
     tableView->setEnabled(false);
     gridView->setEnabled(false);
@@ -710,11 +764,11 @@ void MainWindow::enableButtons()
 
 void MainWindow::enableViews(int romCount, bool cached)
 {
-    QString visibleLayout = SETTINGS.value("View/layout", "table").toString();
+    QString visibleLayout = CACHED_SETTINGS.viewLayout;
 
     // Else no ROMs, so leave views disabled
     if (romCount != 0) {
-        QStringList tableVisible = SETTINGS.value("Table/columns", "Filename|Size").toString().split("|");
+        QStringList tableVisible = CACHED_SETTINGS.tableColumns;
 
         if (tableVisible.join("") != "") {
             tableView->setEnabled(true);
@@ -762,6 +816,53 @@ void MainWindow::enableViews(int romCount, bool cached)
 }
 
 
+void MainWindow::fetchMoreRoms()
+{
+    QString visibleLayout = CACHED_SETTINGS.viewLayout;
+    QScrollBar *scrollBar;
+    RomFilterModel *filterModel;
+
+    if (visibleLayout == "table") {
+        scrollBar = tableView->verticalScrollBar();
+        filterModel = tableView->getFilterModel();
+    } else if (visibleLayout == "grid") {
+        scrollBar = gridView->verticalScrollBar();
+        filterModel = gridView->getFilterModel();
+    } else if (visibleLayout == "list") {
+        scrollBar = listView->verticalScrollBar();
+        filterModel = listView->getFilterModel();
+    } else {
+        return;
+    }
+
+    RomCollectionModel *model = romCollection->getModel();
+
+    // Estimate which rows are on screen from the scroll position.  The view
+    // shows the filtered rows, so map them back to rows of the collection.
+    qint64 rows = filterModel ? filterModel->rowCount() : 0;
+    qint64 range = scrollBar->maximum() + scrollBar->pageStep();
+    if (range > 0 && rows > 0) {
+        int first = rows * scrollBar->value() / range;
+        int last = qMin(rows - 1, rows * (scrollBar->value() + scrollBar->pageStep()) / range);
+
+        model->setViewport(filterModel->mapToSource(filterModel->index(first, 0)).row(),
+                           filterModel->mapToSource(filterModel->index(last, 0)).row());
+    }
+
+    if (scrollBar->value() >= scrollBar->maximum() - scrollBar->pageStep() &&
+        model->canFetchMore(QModelIndex())) {
+        model->fetchMore(QModelIndex());
+    }
+}
+
+
+void MainWindow::focusSearchBar()
+{
+    searchBar->setFocus();
+    searchBar->selectAll();
+}
+
+
 bool MainWindow::eventFilter(QObject*, QEvent *event)
 {
     // Show menu bar if mouse is at top of screen in full-screen mode
@@ -819,7 +920,7 @@ bool MainWindow::eventFilter(QObject*, QEvent *event)
 
 QString MainWindow::getCurrentRomInfoFromView(QString infoName)
 {
-    QString visibleLayout = SETTINGS.value("View/layout", "table").toString();
+    QString visibleLayout = CACHED_SETTINGS.viewLayout;
 
     if (visibleLayout == "table") {
         return tableView->getCurrentRomInfo(infoName);
@@ -833,6 +934,34 @@ QString MainWindow::getCurrentRomInfoFromView(QString infoName)
 }
 
 
+void MainWindow::launchRom(QString romFileName, QString romDirName, QString zipFileName)
+{
+    if (zipFileName == "") {
+        QString path = QDir(romDirName).absoluteFilePath(romFileName);
+        emulation.startGame(path, zipFileName);
+    } else {
+        QString zipPath = QDir(romDirName).absoluteFilePath(zipFileName);
+        emulation.startGame(romFileName, zipPath);
+    }
+}
+
+
+void MainWindow::launchRomFromGrid()
+{
+    launchRom(gridView->getCurrentRomInfo("fileName"),
+              gridView->getCurrentRomInfo("directory"),
+              gridView->getCurrentRomInfo("zipFile"));
+}
+
+
+void MainWindow::launchRomFromList()
+{
+    launchRom(listView->getCurrentRomInfo("fileName"),
+              listView->getCurrentRomInfo("directory"),
+              listView->getCurrentRomInfo("zipFile"));
+}
+
+
 void MainWindow::launchRomFromMenu()
 {
     QString visibleLayout = layoutGroup->checkedAction()->data().toString();
@@ -840,40 +969,18 @@ void MainWindow::launchRomFromMenu()
     if (visibleLayout == "table") {
         launchRomFromTable();
     } else if (visibleLayout == "grid") {
-        launchRomFromWidget(gridView->getCurrentRomWidget());
+        launchRomFromGrid();
     } else if (visibleLayout == "list") {
-        launchRomFromWidget(listView->getCurrentRomWidget());
+        launchRomFromList();
     }
 }
 
 
 void MainWindow::launchRomFromTable()
 {
-    QString romFileName = tableView->getCurrentRomInfo("fileName");
-    QString romDirName = tableView->getCurrentRomInfo("dirName");
-    QString zipFileName = tableView->getCurrentRomInfo("zipFile");
-    if (zipFileName == "") {
-        QString path = QDir(romDirName).absoluteFilePath(romFileName);
-        emulation.startGame(path, zipFileName);
-    } else {
-        QString zipPath = QDir(romDirName).absoluteFilePath(zipFileName);
-        emulation.startGame(romFileName, zipPath);
-    }
-}
-
-
-void MainWindow::launchRomFromWidget(QWidget *current)
-{
-    QString romFileName = current->property("fileName").toString();
-    QString romDirName = current->property("directory").toString();
-    QString zipFileName = current->property("zipFile").toString();
-    if (zipFileName == "") {
-        QString path = QDir(romDirName).absoluteFilePath(romFileName);
-        emulation.startGame(path, zipFileName);
-    } else {
-        QString zipPath = QDir(romDirName).absoluteFilePath(zipFileName);
-        emulation.startGame(romFileName, zipPath);
-    }
+    launchRom(tableView->getCurrentRomInfo("fileName"),
+              tableView->getCurrentRomInfo("dirName"),
+              tableView->getCurrentRomInfo("zipFile"));
 }
 
 
@@ -899,7 +1006,7 @@ void MainWindow::openDeleteDialog()
     scraper->deleteGameInfo(getCurrentRomInfoFromView("fileName"), getCurrentRomInfoFromView("romMD5"));
     delete scraper;
 
-    romCollection->cachedRoms();
+    romCollection->getModel()->updateRom(getCurrentRomInfoFromView("romMD5"));
 }
 
 
@@ -911,7 +1018,7 @@ void MainWindow::openDownloader()
                                   this);
     downloadDialog.exec();
 
-    romCollection->cachedRoms();
+    romCollection->getModel()->updateRom(getCurrentRomInfoFromView("romMD5"));
 }
 
 
@@ -921,6 +1028,29 @@ void MainWindow::openPlugins()
 }
 
 
+void MainWindow::openImport()
+{
+#if QT_VERSION >= 0x050000
+    QString searchPath = QStandardPaths::standardLocations(QStandardPaths::HomeLocation).first();
+#else
+    QString searchPath = QDesktopServices::storageLocation(QDesktopServices::HomeLocation);
+#endif
+
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Import Game Information"), searchPath,
+                                                    tr("TheGamesDB database") + " (*.json);;"
+                                                    + tr("All Files") + " (*)");
+    if (fileName == "")
+        return;
+
+    // Only ROMs without info are looked up, the rest keep what they have
+    int found = romCollection->importGameInfo(fileName);
+
+    if (found >= 0)
+        QMessageBox::information(this, tr("Import Game Information"),
+                                 QString(tr("Imported information for %1 games.")).arg(found));
+}
+
+
 void MainWindow::openInputConfig()
 {
     if (getCurrentInputPlugin() != "") {
@@ -973,40 +1103,46 @@ void MainWindow::openSettings()
 
 void MainWindow::openSettings(int tab)
 {
-    QString tableImageBefore = SETTINGS.value("Table/imagesize", "Medium").toString();
-    QString columnsBefore = SETTINGS.value("Table/columns", "Filename|Size").toString();
-    QString downloadBefore = SETTINGS.value("Other/downloadinfo", "").toString();
+    // The dialog reads and writes QSettings directly
+    SettingsStore::instance()->flush();
+
+    SettingsSnapshot before = CACHED_SETTINGS;
+    QString dataBefore = SETTINGS.value("Paths/data", "").toString();
+    QString catalogBefore = SETTINGS.value("Paths/catalog", "").toString();
 
     SettingsDialog settingsDialog(this, tab);
     settingsDialog.exec();
 
-    QString tableImageAfter = SETTINGS.value("Table/imagesize", "Medium").toString();
-    QString columnsAfter = SETTINGS.value("Table/columns", "Filename|Size").toString();
-    QString downloadAfter = SETTINGS.value("Other/downloadinfo", "").toString();
+    SettingsStore::instance()->reload();
+
+    SettingsSnapshot after = CACHED_SETTINGS;
+    QString dataAfter = SETTINGS.value("Paths/data", "").toString();
+    QString catalogAfter = SETTINGS.value("Paths/catalog", "").toString();
+    bool imageUpdated = before.tableImageSize != after.tableImageSize;
 
     // Reset columns widths if user has selected different columns to display
-    if (columnsBefore != columnsAfter) {
+    if (before.tableColumns != after.tableColumns) {
         SETTINGS.setValue("Table/width", "");
-        tableView->setColumnCount(3);
-        tableView->setHeaderLabels(QStringList(""));
     }
 
     QStringList romSave = SETTINGS.value("Paths/roms","").toString().split("|");
     if (romCollection->romPaths != romSave) {
         romCollection->updatePaths(romSave);
         romCollection->addRoms();
-    } else if (downloadBefore == "" && downloadAfter == "true") {
+    } else if (!before.downloadInfo && after.downloadInfo) {
         romCollection->addRoms();
+    } else if (before.downloadInfo != after.downloadInfo || dataBefore != dataAfter || catalogBefore != catalogAfter) {
+        // ROM info comes from these, so the loaded rows have to be read again
+        romCollection->cachedRoms(imageUpdated);
     } else {
-        if (tableImageBefore != tableImageAfter) {
-            romCollection->cachedRoms(true);
-        } else {
-            romCollection->cachedRoms(false);
-        }
+        // Only the presentation changed, so render the rows that are already loaded
+        romCollection->updateSort();
+        tableView->resetView(imageUpdated);
+        tableView->refreshView();
+        gridView->refreshView();
+        listView->refreshView();
     }
 
-    gridView->setGridBackground();
-    listView->setListBackground();
     toggleMenus(true);
 }
 
@@ -1097,6 +1233,31 @@ void MainWindow::openZipDialog(QStringList zippedFiles)
 }
 
 
+void MainWindow::releaseLibrary()
+{
+    // A running game shouldn't be woken to check on the library's event loop
+    StallWatchdog::instance()->setPaused(true);
+
+    if (!CACHED_SETTINGS.gamingMode)
+        return;
+
+    // The library is out of sight while a game runs, so leave the game the
+    // memory it uses.  What stays is the model's rows with their database
+    // columns and the search and facet indexes, enough to show the library
+    // again without a reload; game info is read back in one query.
+    CoverLoader::instance()->setPaused(true);
+    romCollection->setDownloadsPaused(true);
+    CoverCache::instance()->clear();
+    romCollection->getModel()->releaseRows();
+    RomMetadataStore::instance()->release();
+    gridView->releaseView();
+    listView->releaseView();
+    QPixmapCache::clear();
+
+    libraryReleased = true;
+}
+
+
 void MainWindow::resetLayouts(bool imageUpdated)
 {
     tableView->resetView(imageUpdated);
@@ -1105,9 +1266,27 @@ void MainWindow::resetLayouts(bool imageUpdated)
 }
 
 
+void MainWindow::restoreLibrary()
+{
+    StallWatchdog::instance()->setPaused(false);
+
+    if (!libraryReleased)
+        return;
+
+    libraryReleased = false;
+
+    // Rows and covers come back as the views paint them, the ones on
+    // screen first.
+    CoverLoader::instance()->setPaused(false);
+    romCollection->setDownloadsPaused(false);
+    gridView->restoreView();
+    listView->restoreView();
+}
+
+
 void MainWindow::showActiveView()
 {
-    QString visibleLayout = SETTINGS.value("View/layout", "table").toString();
+    QString visibleLayout = CACHED_SETTINGS.viewLayout;
 
     if (visibleLayout == "table") {
         tableView->setHidden(false);
@@ -1140,7 +1319,7 @@ void MainWindow::showRomMenu(const QPoint &pos)
     connect(contextStartAction, SIGNAL(triggered()), this, SLOT(launchRomFromMenu()));
     connect(contextConfigureGameAction, SIGNAL(triggered()), this, SLOT(openGameSettings()));
 
-    if (SETTINGS.value("Other/downloadinfo", "").toString() == "true") {
+    if (CACHED_SETTINGS.downloadInfo) {
         contextMenu->addSeparator();
         QAction *contextDownloadAction = contextMenu->addAction(tr("&Download/Update Info..."));
         QAction *contextDeleteAction = contextMenu->addAction(tr("D&elete Current Info..."));
@@ -1151,14 +1330,14 @@ void MainWindow::showRomMenu(const QPoint &pos)
 
 
     QWidget *activeWidget = new QWidget(this);
-    QString visibleLayout = SETTINGS.value("View/layout", "table").toString();
+    QString visibleLayout = CACHED_SETTINGS.viewLayout;
 
     if (visibleLayout == "table") {
         activeWidget = tableView->viewport();
     } else if (visibleLayout == "grid") {
-        activeWidget = gridView->getCurrentRomWidget();
+        activeWidget = gridView->viewport();
     } else if (visibleLayout == "list") {
-        activeWidget = listView->getCurrentRomWidget();
+        activeWidget = listView->viewport();
     }
 
     contextMenu->exec(activeWidget->mapToGlobal(pos));
@@ -1177,6 +1356,12 @@ void MainWindow::showCheats()
 }
 
 
+void MainWindow::tableSortChanged()
+{
+    romCollection->updateSort();
+}
+
+
 void MainWindow::toggleMenus(bool active)
 {
     foreach (QAction *next, menuEnable) {
@@ -1200,9 +1385,10 @@ void MainWindow::toggleMenus(bool active)
         }
     }
 
-    if (SETTINGS.value("Other/downloadinfo", "").toString() == "") {
+    if (!CACHED_SETTINGS.downloadInfo) {
         downloadAction->setEnabled(false);
         deleteAction->setEnabled(false);
+        importAction->setEnabled(false);
     }
 }
 
@@ -1231,21 +1417,47 @@ void MainWindow::updateFullScreenMode()
 }
 
 
+void MainWindow::updateFacetSetting()
+{
+    SettingsSnapshot settings = CACHED_SETTINGS;
+    settings.showFacets = facetAction->isChecked();
+    SettingsStore::instance()->update(settings);
+
+    if (!settings.showFacets) {
+        // Hidden filters shouldn't keep hiding ROMs
+        foreach (QString field, RomFacetIndex::getFields()) {
+            romCollection->getModel()->setFacetFilter(field, QStringList());
+        }
+    }
+
+    QString visibleLayout = CACHED_SETTINGS.viewLayout;
+    facetPanel->setHidden(visibleLayout == "none" || !facetAction->isChecked());
+}
+
+
 void MainWindow::updateLayoutSetting()
 {
     QString visibleLayout = layoutGroup->checkedAction()->data().toString();
-    SETTINGS.setValue("View/layout", visibleLayout);
+
+    SettingsSnapshot settings = CACHED_SETTINGS;
+    settings.viewLayout = visibleLayout;
+    SettingsStore::instance()->update(settings);
 
     emptyView->setHidden(true);
     tableView->setHidden(true);
     gridView->setHidden(true);
     listView->setHidden(true);
     disabledView->setHidden(true);
+    searchBar->setHidden(visibleLayout == "none");
+    facetPanel->setHidden(visibleLayout == "none" || !facetAction->isChecked());
 
-    int romCount = romCollection->cachedRoms();
+    // Each layout has its own sort, the rows themselves are already loaded
+    romCollection->updateSort();
 
-    if (romCount > 0 || visibleLayout == "none") {
+    if (romCollection->getModel()->getTotalCount() > 0 || visibleLayout == "none") {
         showActiveView();
+    } else {
+        disabledView->setHidden(false);
     }
 
     // View was updated so no ROM will be selected. Update menu items accordingly
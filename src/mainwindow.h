@@ -35,25 +35,28 @@
 
 
 #include <QMainWindow>
+#include <QModelIndex>
 #include <QSurfaceFormat>
 
 class QActionGroup;
 class QDialogButtonBox;
+class QHBoxLayout;
 class QHeaderView;
 class QGridLayout;
 class QLabel;
+class QLineEdit;
 class QListWidget;
 class QMenuBar;
 class QScrollArea;
 class QTreeWidget;
 class QVBoxLayout;
 class EmulatorHandler;
+class FacetPanel;
 class GridView;
 class ListView;
 class RomCollection;
 class TableView;
 class TheGamesDBScraper;
-class TreeWidgetItem;
 struct Rom;
 
 
@@ -72,6 +75,7 @@ private:
     void autoloadSettings();
     void createMenu();
     void createRomView();
+    void launchRom(QString romFileName, QString romDirName, QString zipFileName);
     void openZipDialog(QStringList zippedFiles);
     void resetLayouts(bool imageUpdated = false);
     void showActiveView();
@@ -88,7 +92,9 @@ private:
     QAction *pluginsAction;
     QAction *configInputAction;
     QAction *editorAction;
+    QAction *facetAction;
     QAction *fullScreenAction;
+    QAction *importAction;
     QAction *logAction;
     QAction *openAction;
     QAction *quitAction;
@@ -98,6 +104,7 @@ private:
     QAction *pauseAction;
     QAction *frameAction;
     QAction *resetAction;
+    QAction *searchAction;
     QAction *saveStateAction;
     QAction *loadStateAction;
     QAction *stopAction;
@@ -109,6 +116,7 @@ private:
     QGridLayout *zipLayout;
     QLabel *emptyIcon;
     QLabel *disabledLabel;
+    QLineEdit *searchBar;
     QList<QAction*> menuEnable;
     QList<QAction*> menuDisable;
     QList<QAction*> menuRomSelected;
@@ -122,33 +130,39 @@ private:
     QMenu *viewMenu;
     QMenuBar *menuBar;
     QScrollArea *emptyView;
+    QHBoxLayout *viewLayout;
     QVBoxLayout *disabledLayout;
     QVBoxLayout *mainLayout;
     QWidget *disabledView;
     QWidget *mainWidget;
 
+    FacetPanel *facetPanel;
     GridView *gridView;
     ListView *listView;
     RomCollection *romCollection;
     TableView *tableView;
     TheGamesDBScraper *scraper;
-    TreeWidgetItem *fileItem;
     // Saved when a game is started so we can restore the window.
     QByteArray mainGeometry;
+    // Set while gaming mode has the library's caches released.
+    bool libraryReleased;
 
 private slots:
-    void addToView(Rom *currentRom, int count);
     void disableButtons();
     void disableViews(bool imageUpdated);
     void enableButtons();
     void enableViews(int romCount, bool cached);
+    void fetchMoreRoms();
+    void focusSearchBar();
+    void launchRomFromGrid();
+    void launchRomFromList();
     void launchRomFromMenu();
     void launchRomFromTable();
-    void launchRomFromWidget(QWidget *current);
     void launchRomFromZip();
     void openAboutGui();
     void openDeleteDialog();
     void openDownloader();
+    void openImport();
     void openPlugins();
     void openInputConfig();
     void openEditor();
@@ -156,6 +170,8 @@ private slots:
     void openLog();
     void openSettings();
     void openRom();
+    void releaseLibrary();
+    void restoreLibrary();
     void createGlWindow(QSurfaceFormat *format);
     void destroyGlWindow();
     void resizeWindow(int width, int height);
@@ -163,8 +179,10 @@ private slots:
     void showRomMenu(const QPoint &);
     void stopEmulator();
     void showCheats();
+    void tableSortChanged();
     void toggleMenus(bool active);
     void updateFullScreenMode();
+    void updateFacetSetting();
     void updateLayoutSetting();
     void emulationResumed();
     void emulationPaused();
@@ -0,0 +1,128 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#include "covercache.h"
+
+#include "../global.h"
+#include "../error.h"
+
+#include <QCoreApplication>
+
+
+CoverCache::CoverCache() : QObject(0)
+{
+    hits = 0;
+    misses = 0;
+
+    updateBudget();
+    connect(SettingsStore::instance(), SIGNAL(changed()), this, SLOT(updateBudget()));
+    connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(logStatistics()));
+}
+
+
+void CoverCache::clear()
+{
+    //Statistics are kept, they cover the whole session
+    pixmaps.clear();
+}
+
+
+bool CoverCache::find(const QString &key, QPixmap *pixmap)
+{
+    QPixmap *cached = pixmaps.object(key);
+
+    if (cached == NULL) {
+        misses++;
+        return false;
+    }
+
+    hits++;
+    *pixmap = *cached;
+    return true;
+}
+
+
+QString CoverCache::getKey(const QString &md5, const QSize &size, CoverLoader::ScaleMode mode)
+{
+    return md5 + "/" + (mode == CoverLoader::FitCover ? "fit/" : "boxart/")
+         + QString::number(size.width()) + "x" + QString::number(size.height());
+}
+
+
+CoverCache::Statistics CoverCache::getStatistics() const
+{
+    Statistics statistics;
+    statistics.hits = hits;
+    statistics.misses = misses;
+    statistics.count = pixmaps.count();
+    statistics.usedKB = pixmaps.totalCost();
+    statistics.budgetKB = pixmaps.maxCost();
+    return statistics;
+}
+
+
+void CoverCache::insert(const QString &key, const QPixmap &pixmap)
+{
+    int cost = qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024);
+    pixmaps.insert(key, new QPixmap(pixmap), cost);
+}
+
+
+CoverCache *CoverCache::instance()
+{
+    static CoverCache *cache = new CoverCache;
+    return cache;
+}
+
+
+void CoverCache::logStatistics()
+{
+    Statistics statistics = getStatistics();
+    QString message = QString("Cover cache: %1 hits, %2 misses, %3 covers in %4 of %5 KB")
+                        .arg(statistics.hits).arg(statistics.misses).arg(statistics.count)
+                        .arg(statistics.usedKB).arg(statistics.budgetKB);
+
+    LOG_I(message);
+}
+
+
+void CoverCache::remove(const QString &md5)
+{
+    foreach (QString key, pixmaps.keys())
+        if (key.startsWith(md5 + "/"))
+            pixmaps.remove(key);
+}
+
+
+void CoverCache::updateBudget()
+{
+    //Shrinking evicts the least recently used covers right away
+    pixmaps.setMaxCost(qMax(1, CACHED_SETTINGS.coverCacheSize) * 1024);
+}
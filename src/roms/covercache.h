@@ -0,0 +1,83 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#ifndef COVERCACHE_H
+#define COVERCACHE_H
+
+#include "coverloader.h"
+
+#include <QCache>
+#include <QObject>
+#include <QPixmap>
+#include <QString>
+
+
+// Scaled covers shared by all views, keyed by md5, scale mode and size,
+// so views showing covers the same way share one pixmap.  The least
+// recently used covers are evicted once the pixmaps go over the budget
+// in the Other/covercachesize setting (MB).  Hits and misses are counted
+// and written to the log on exit.
+//
+// Only use from the GUI thread.
+class CoverCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Statistics {
+        qint64 hits;
+        qint64 misses;
+        int count;
+        int usedKB;
+        int budgetKB;
+    };
+
+    static CoverCache *instance();
+    static QString getKey(const QString &md5, const QSize &size, CoverLoader::ScaleMode mode);
+
+    void clear();
+    bool find(const QString &key, QPixmap *pixmap);
+    Statistics getStatistics() const;
+    void insert(const QString &key, const QPixmap &pixmap);
+    void remove(const QString &md5);
+
+private:
+    CoverCache();
+
+    QCache<QString, QPixmap> pixmaps;
+    qint64 hits;
+    qint64 misses;
+
+private slots:
+    void logStatistics();
+    void updateBudget();
+};
+
+#endif // COVERCACHE_H
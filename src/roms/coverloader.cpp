@@ -0,0 +1,322 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#include "coverloader.h"
+
+#include "../global.h"
+#include "../common.h"
+
+#include "coverscaler.h"
+#include "thumbnailpack.h"
+
+#include <QColor>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QPixmapCache>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+
+// Finished covers not yet painted, in KB
+static const int ReadyCacheSize = 16384;
+
+
+class CoverTask : public QRunnable
+{
+public:
+    CoverTask(CoverLoader *loader, QString key, QString md5, QString fileName, QSize size,
+              CoverLoader::ScaleMode mode)
+        : loader(loader), key(key), md5(md5), fileName(fileName), size(size), mode(mode) {}
+
+    void run()
+    {
+        QImage image(fileName);
+
+        if (!image.isNull()) {
+            Qt::AspectRatioMode aspectRatioMode = Qt::KeepAspectRatio;
+
+            if (mode == CoverLoader::StretchBoxArt) {
+                //Use uniform aspect ratio to account for fluctuations in TheGamesDB box art
+                float aspectRatio = float(image.width()) / image.height();
+
+                if (aspectRatio >= 1.1 && aspectRatio <= 1.8)
+                    aspectRatioMode = Qt::IgnoreAspectRatio;
+            }
+
+            image = scaleCover(image, image.size().scaled(size, aspectRatioMode));
+        }
+
+        QMetaObject::invokeMethod(loader, "finishCover", Qt::QueuedConnection,
+                                  Q_ARG(QString, key), Q_ARG(QString, md5), Q_ARG(QImage, image));
+    }
+
+private:
+    CoverLoader *loader;
+    QString key;
+    QString md5;
+    QString fileName;
+    QSize size;
+    CoverLoader::ScaleMode mode;
+};
+
+
+CoverLoader::CoverLoader()
+{
+    //Leave a core for the GUI thread and the emulator
+    pool = new QThreadPool(this);
+    pool->setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+
+    running = 0;
+    requestSerial = 0;
+    collecting = false;
+    paused = false;
+
+    ready.setMaxCost(ReadyCacheSize);
+}
+
+
+void CoverLoader::beginRequests()
+{
+    collecting = true;
+
+    for (QHash<QString, CoverRequest>::iterator request = pending.begin(); request != pending.end(); ++request)
+        request->wanted = false;
+}
+
+
+void CoverLoader::clearCover(const QString &md5)
+{
+    missing.remove(md5);
+
+    foreach (QString key, ready.keys())
+        if (key.startsWith(md5 + "/"))
+            ready.remove(key);
+
+    foreach (ThumbnailPack *pack, packs)
+        pack->remove(md5);
+}
+
+
+void CoverLoader::endRequests()
+{
+    collecting = false;
+
+    //Whatever was not asked for again went out of view, running ones just finish
+    QHash<QString, CoverRequest>::iterator request = pending.begin();
+    while (request != pending.end()) {
+        if (!request->wanted && !request->running)
+            request = pending.erase(request);
+        else
+            ++request;
+    }
+
+    startRequests();
+}
+
+
+void CoverLoader::finishCover(QString key, QString md5, QImage image)
+{
+    running--;
+    CoverRequest cover = pending.take(key);
+
+    if (image.isNull()) {
+        missing.insert(md5);
+    } else if (!paused) {
+        if (cover.pack != NULL)
+            cover.pack->insert(md5, cover.sourceSize, cover.sourceModified, image);
+        ready.insert(key, new QImage(image), qMax(1, image.byteCount() / 1024));
+    }
+
+    startRequests();
+    emit coverLoaded(md5);
+}
+
+
+ThumbnailPack *CoverLoader::getPack(const QSize &size, ScaleMode mode)
+{
+    //One pack for every size and scale mode a view uses
+    QString name = QString(mode == FitCover ? "fit" : "boxart")
+                 + "-" + QString::number(size.width()) + "x" + QString::number(size.height());
+
+    ThumbnailPack *pack = packs.value(name);
+    if (pack == NULL) {
+        QString directory = getCacheLocation() + "thumbnails";
+        QDir().mkpath(directory);
+
+        pack = new ThumbnailPack(directory + "/" + name + ".pack");
+        packs.insert(name, pack);
+    }
+
+    return pack;
+}
+
+
+QPixmap CoverLoader::getPlaceholder(const QSize &size)
+{
+    QString key = "cover-placeholder/" + QString::number(size.width()) + "x" + QString::number(size.height());
+
+    QPixmap placeholder;
+    if (!QPixmapCache::find(key, &placeholder)) {
+        placeholder = QPixmap(size);
+        placeholder.fill(QColor(128, 128, 128, 60));
+        QPixmapCache::insert(key, placeholder);
+    }
+
+    return placeholder;
+}
+
+
+CoverLoader *CoverLoader::instance()
+{
+    static CoverLoader *loader = new CoverLoader;
+    return loader;
+}
+
+
+CoverLoader::CoverState CoverLoader::loadCover(const QString &key, const QString &md5, const QSize &size,
+                                               ScaleMode mode, QImage *image, CoverPriority priority)
+{
+    //Covers only come with the downloaded game info
+    if (!CACHED_SETTINGS.downloadInfo || missing.contains(md5))
+        return CoverMissing;
+
+    //Asked for again once the loader resumes
+    if (paused)
+        return CoverPending;
+
+    QImage *finished = ready.take(key);
+    if (finished != NULL) {
+        *image = *finished;
+        delete finished;
+        return CoverReady;
+    }
+
+    QHash<QString, CoverRequest>::iterator request = pending.find(key);
+    if (request != pending.end()) {
+        //Keeps its place, but a prefetched cover that came into view goes first
+        request->priority = qMax(request->priority, priority);
+        request->wanted = true;
+        return CoverPending;
+    }
+
+    //Deleted game info leaves an empty cover behind
+    QString path = getCacheLocation() + md5.toLower() + "/boxart-front.";
+    QFileInfo source(path + "jpg");
+    if (!source.exists())
+        source.setFile(path + "png");
+
+    if (!source.exists() || source.size() == 0) {
+        missing.insert(md5);
+        return CoverMissing;
+    }
+
+    ThumbnailPack *pack = getPack(size, mode);
+    qint64 sourceModified = source.lastModified().toMSecsSinceEpoch();
+
+    if (pack->find(md5, source.size(), sourceModified, image))
+        return CoverReady;
+
+    CoverRequest cover;
+    cover.md5 = md5;
+    cover.fileName = source.filePath();
+    cover.size = size;
+    cover.mode = mode;
+    cover.priority = priority;
+    cover.serial = ++requestSerial;
+    cover.wanted = true;
+    cover.running = false;
+    cover.pack = pack;
+    cover.sourceSize = source.size();
+    cover.sourceModified = sourceModified;
+    pending.insert(key, cover);
+
+    //While a view lists what it wants, wait for the whole list before choosing
+    if (!collecting)
+        startRequests();
+
+    return CoverPending;
+}
+
+
+void CoverLoader::setPaused(bool pause)
+{
+    paused = pause;
+
+    if (!paused) {
+        startRequests();
+        return;
+    }
+
+    //Running covers still finish but are thrown away, their pack goes with the others
+    QHash<QString, CoverRequest>::iterator request = pending.begin();
+    while (request != pending.end()) {
+        if (request->running) {
+            request->pack = NULL;
+            ++request;
+        } else {
+            request = pending.erase(request);
+        }
+    }
+
+    ready.clear();
+
+    qDeleteAll(packs);
+    packs.clear();
+}
+
+
+void CoverLoader::startRequests()
+{
+    if (paused)
+        return;
+
+    //Hand the workers the most important requests, the oldest first within a priority
+    while (running < pool->maxThreadCount()) {
+        QHash<QString, CoverRequest>::iterator next = pending.end();
+
+        for (QHash<QString, CoverRequest>::iterator request = pending.begin(); request != pending.end(); ++request) {
+            if (request->running)
+                continue;
+
+            if (next == pending.end() || request->priority > next->priority ||
+                (request->priority == next->priority && request->serial < next->serial))
+                next = request;
+        }
+
+        if (next == pending.end())
+            break;
+
+        next->running = true;
+        running++;
+        pool->start(new CoverTask(this, next.key(), next->md5, next->fileName, next->size, next->mode));
+    }
+}
@@ -0,0 +1,132 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#ifndef COVERLOADER_H
+#define COVERLOADER_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QString>
+
+class QThreadPool;
+class ThumbnailPack;
+
+
+// Reads box art from the game info cache when a view first needs it.
+//
+// Views ask for a cover with loadCover() while painting.  Covers scaled
+// before come straight from a ThumbnailPack for the size.  Others are
+// decoded and scaled on a worker thread, added to the pack, and
+// coverLoaded() is emitted once they can be taken, so startup never waits
+// on image decoding.  Finished covers are handed over once; the views
+// keep the scaled pixmaps in CoverCache.
+//
+// Requests wait in a queue of their own and only as many are handed to
+// the workers as there are threads.  Covers on screen go before the ones
+// prefetched, and when a view scrolls it brackets the covers it still
+// wants with beginRequests() and endRequests(), which drops the queued
+// requests for items that went out of view.  While a game runs the loader
+// can be paused, which also lets go of the finished covers and the packs.
+//
+// Only use from the GUI thread.
+class CoverLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum CoverState {
+        CoverPending,
+        CoverReady,
+        CoverMissing
+    };
+
+    enum ScaleMode {
+        FitCover,       // Keep the aspect ratio inside the size
+        StretchBoxArt   // Fill the size unless the art is far from the usual box shape (JP box art)
+    };
+
+    enum CoverPriority {
+        PrefetchPriority,
+        VisiblePriority
+    };
+
+    static CoverLoader *instance();
+    static QPixmap getPlaceholder(const QSize &size);
+
+    void beginRequests();
+    void clearCover(const QString &md5);
+    void endRequests();
+    CoverState loadCover(const QString &key, const QString &md5, const QSize &size,
+                         ScaleMode mode, QImage *image, CoverPriority priority = VisiblePriority);
+    void setPaused(bool pause);
+
+signals:
+    void coverLoaded(QString md5);
+
+private:
+    struct CoverRequest {
+        QString md5;
+        QString fileName;
+        QSize size;
+        ScaleMode mode;
+        CoverPriority priority;
+        quint64 serial;
+        bool wanted;
+        bool running;
+
+        ThumbnailPack *pack;
+        qint64 sourceSize;
+        qint64 sourceModified;
+    };
+
+    CoverLoader();
+    void startRequests();
+    ThumbnailPack *getPack(const QSize &size, ScaleMode mode);
+
+    QThreadPool *pool;
+    int running;
+    quint64 requestSerial;
+    bool collecting;
+    bool paused;
+    QHash<QString, CoverRequest> pending;
+    QCache<QString, QImage> ready;
+    QSet<QString> missing;
+    QHash<QString, ThumbnailPack*> packs;
+
+private slots:
+    void finishCover(QString key, QString md5, QImage image);
+};
+
+#endif // COVERLOADER_H
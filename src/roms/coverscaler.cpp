@@ -0,0 +1,227 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#include "coverscaler.h"
+
+#include <QVector>
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COVERSCALER_SSE2
+#endif
+
+
+// Weights are fixed point, small enough to multiply 16 bit channels in 32 bits
+static const int WeightShift = 14;
+static const int WeightOne = 1 << WeightShift;
+
+
+// The source pixels one target pixel covers, weights index into the weight list
+struct Span {
+    int first;
+    int count;
+    int weights;
+};
+
+
+static QVector<Span> getSpans(int source, int target, QVector<int> &weights)
+{
+    QVector<Span> spans(target);
+    double scale = double(source) / target;
+
+    for (int i = 0; i < target; i++) {
+        double start = i * scale;
+        double end = qMin(double(source), (i + 1) * scale);
+
+        Span &span = spans[i];
+        span.first = int(start);
+        span.count = qMax(1, int(ceil(end)) - span.first);
+        span.weights = weights.size();
+
+        //Pixels cut at the edges count by how much of them is covered, and the
+        //last one takes the rounding so every span adds up to exactly one
+        int total = 0;
+        for (int j = 0; j < span.count; j++) {
+            int weight = WeightOne - total;
+
+            if (j < span.count - 1) {
+                double covered = qMin(end, double(span.first + j + 1)) - qMax(start, double(span.first + j));
+                weight = qRound(covered / scale * WeightOne);
+            }
+
+            weights.append(weight);
+            total += weight;
+        }
+    }
+
+    return spans;
+}
+
+
+#ifdef COVERSCALER_SSE2
+
+static inline __m128i getChannels(QRgb pixel)
+{
+    __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), zero), zero);
+}
+
+
+static inline QRgb getPixel(__m128i sum)
+{
+    sum = _mm_srai_epi32(sum, WeightShift);
+    sum = _mm_packs_epi32(sum, sum);
+    return _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+}
+
+
+static void scaleRow(const QRgb *source, QRgb *target, const QVector<Span> &spans, const int *weights)
+{
+    for (int x = 0; x < spans.size(); x++) {
+        const QRgb *pixel = source + spans[x].first;
+        const int *weight = weights + spans[x].weights;
+
+        //Channels sit in the low half of each 32 bit lane, so madd is a plain multiply
+        __m128i sum = _mm_set1_epi32(WeightOne / 2);
+        for (int i = 0; i < spans[x].count; i++)
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(getChannels(pixel[i]), _mm_set1_epi32(weight[i])));
+
+        target[x] = getPixel(sum);
+    }
+}
+
+
+static void addRow(const QRgb *source, qint32 *sums, int width, int weight)
+{
+    __m128i factor = _mm_set1_epi32(weight);
+
+    for (int x = 0; x < width; x++) {
+        __m128i *sum = reinterpret_cast<__m128i*>(sums + x * 4);
+        _mm_storeu_si128(sum, _mm_add_epi32(_mm_loadu_si128(sum),
+                                            _mm_madd_epi16(getChannels(source[x]), factor)));
+    }
+}
+
+
+static void storeRow(const qint32 *sums, QRgb *target, int width)
+{
+    for (int x = 0; x < width; x++)
+        target[x] = getPixel(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x * 4)));
+}
+
+#else
+
+static inline QRgb getPixel(const qint32 *sum)
+{
+    return qRgba(qBound(0, sum[2] >> WeightShift, 255), qBound(0, sum[1] >> WeightShift, 255),
+                 qBound(0, sum[0] >> WeightShift, 255), qBound(0, sum[3] >> WeightShift, 255));
+}
+
+
+static inline void addPixel(qint32 *sum, QRgb pixel, int weight)
+{
+    sum[0] += qBlue(pixel) * weight;
+    sum[1] += qGreen(pixel) * weight;
+    sum[2] += qRed(pixel) * weight;
+    sum[3] += qAlpha(pixel) * weight;
+}
+
+
+static void scaleRow(const QRgb *source, QRgb *target, const QVector<Span> &spans, const int *weights)
+{
+    for (int x = 0; x < spans.size(); x++) {
+        const QRgb *pixel = source + spans[x].first;
+        const int *weight = weights + spans[x].weights;
+
+        qint32 sum[4] = { WeightOne / 2, WeightOne / 2, WeightOne / 2, WeightOne / 2 };
+        for (int i = 0; i < spans[x].count; i++)
+            addPixel(sum, pixel[i], weight[i]);
+
+        target[x] = getPixel(sum);
+    }
+}
+
+
+static void addRow(const QRgb *source, qint32 *sums, int width, int weight)
+{
+    for (int x = 0; x < width; x++)
+        addPixel(sums + x * 4, source[x], weight);
+}
+
+
+static void storeRow(const qint32 *sums, QRgb *target, int width)
+{
+    for (int x = 0; x < width; x++)
+        target[x] = getPixel(sums + x * 4);
+}
+
+#endif
+
+
+QImage scaleCover(const QImage &image, const QSize &size)
+{
+    if (image.isNull() || size.isEmpty())
+        return QImage();
+
+    if (size.width() > image.width() || size.height() > image.height())
+        return image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                    .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    //Averaging is only right on premultiplied pixels
+    QImage source = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    QVector<int> columnWeights;
+    QVector<int> rowWeights;
+    QVector<Span> columns = getSpans(source.width(), size.width(), columnWeights);
+    QVector<Span> rows = getSpans(source.height(), size.height(), rowWeights);
+
+    //Narrow every source row once, then average the narrowed rows
+    QImage narrow(size.width(), source.height(), QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < source.height(); y++)
+        scaleRow(reinterpret_cast<const QRgb*>(source.constScanLine(y)),
+                 reinterpret_cast<QRgb*>(narrow.scanLine(y)), columns, columnWeights.constData());
+
+    QImage target(size, QImage::Format_ARGB32_Premultiplied);
+    QVector<qint32> sums(size.width() * 4);
+
+    for (int y = 0; y < size.height(); y++) {
+        sums.fill(WeightOne / 2);
+
+        for (int i = 0; i < rows[y].count; i++)
+            addRow(reinterpret_cast<const QRgb*>(narrow.constScanLine(rows[y].first + i)), sums.data(),
+                   size.width(), rowWeights[rows[y].weights + i]);
+
+        storeRow(sums.constData(), reinterpret_cast<QRgb*>(target.scanLine(y)), size.width());
+    }
+
+    return target;
+}
@@ -1,5 +1,5 @@
 /***
- * Copyright (c) 2013, Dan Hasting
+ * Copyright (c) 2019, Robert Alm Nilsson
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -28,19 +28,19 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *
  ***/
+#ifndef COVERSCALER_H
+#define COVERSCALER_H
 
-#ifndef TREEWIDGETITEM_H
-#define TREEWIDGETITEM_H
+#include <QImage>
+#include <QSize>
 
-#include <QTreeWidgetItem>
 
+// Shrinks a cover to exactly size by averaging the source pixels each
+// target pixel covers (a box filter weighted by coverage), which is what
+// a thumbnail wants and is cheaper than Qt's smooth scaling.  The result
+// is premultiplied ARGB.  Enlarging falls back to QImage::scaled().
+//
+// Safe to call from any thread.
+QImage scaleCover(const QImage &image, const QSize &size);
 
-class TreeWidgetItem : public QTreeWidgetItem
-{
-public:
-    TreeWidgetItem(QTreeWidget *parent) : QTreeWidgetItem(parent) {}
-    bool operator< (const QTreeWidgetItem &other) const;
-};
-
-
-#endif // TREEWIDGETITEM_H
+#endif // COVERSCALER_H
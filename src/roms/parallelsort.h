@@ -0,0 +1,79 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef PARALLELSORT_H
+#define PARALLELSORT_H
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+
+
+// Smallest chunk worth handing to another thread when sorting
+static const int SortChunkSize = 2048;
+
+
+// Stable sorts the list in chunks on the global thread pool and merges
+// the sorted chunks afterwards. Small lists are sorted on this thread.
+template <typename T, typename LessThan>
+void parallelStableSort(QVector<T> &list, LessThan lessThan, int chunkSize = SortChunkSize)
+{
+    int chunks = qMin(QThread::idealThreadCount(), list.size() / chunkSize);
+
+    if (chunks < 2) {
+        std::stable_sort(list.begin(), list.end(), lessThan);
+        return;
+    }
+
+    T *data = list.data();
+
+    QVector<int> bounds;
+    QVector<int> chunkList;
+    for (int chunk = 0; chunk <= chunks; chunk++) {
+        bounds << int(qint64(list.size()) * chunk / chunks);
+        if (chunk < chunks)
+            chunkList << chunk;
+    }
+
+    QtConcurrent::blockingMap(chunkList, [data, &bounds, lessThan](int &chunk) {
+        std::stable_sort(data + bounds[chunk], data + bounds[chunk + 1], lessThan);
+    });
+
+    //Merge neighbouring runs, doubling the run length each pass
+    for (int width = 1; width < chunks; width *= 2)
+        for (int chunk = 0; chunk + width < chunks; chunk += width * 2)
+            std::inplace_merge(data + bounds[chunk], data + bounds[chunk + width],
+                               data + bounds[qMin(chunk + width * 2, chunks)], lessThan);
+}
+
+#endif // PARALLELSORT_H
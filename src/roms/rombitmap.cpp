@@ -0,0 +1,310 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "rombitmap.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <iterator>
+
+
+// Largest array container before it is stored as a bitmap instead.
+// At this size both take the same 8 KiB.
+static const int ArrayLimit = 4096;
+
+static const int BitmapWords = 65536 / 64;
+
+
+void RomBitmap::add(quint32 value)
+{
+    Container &container = containers[value >> 16];
+    quint16 low = value & 0xFFFF;
+
+    if (container.isBitmap()) {
+        quint64 &word = container.bits[low / 64];
+        quint64 bit = quint64(1) << (low % 64);
+        if (!(word & bit)) {
+            word |= bit;
+            container.cardinality++;
+        }
+        return;
+    }
+
+    QVector<quint16>::iterator position = std::lower_bound(container.array.begin(), container.array.end(), low);
+    if (position != container.array.end() && *position == low)
+        return;
+
+    container.array.insert(position, low);
+    container.cardinality++;
+
+    if (container.cardinality > ArrayLimit)
+        toBitmap(container);
+}
+
+
+int RomBitmap::cardinality() const
+{
+    int count = 0;
+    foreach (const Container &container, containers)
+        count += container.cardinality;
+
+    return count;
+}
+
+
+bool RomBitmap::contains(quint32 value) const
+{
+    QMap<quint16, Container>::const_iterator container = containers.constFind(value >> 16);
+    if (container == containers.constEnd())
+        return false;
+
+    quint16 low = value & 0xFFFF;
+
+    if (container->isBitmap())
+        return container->bits.at(low / 64) & (quint64(1) << (low % 64));
+
+    return std::binary_search(container->array.constBegin(), container->array.constEnd(), low);
+}
+
+
+RomBitmap::Container RomBitmap::intersect(const Container &first, const Container &last)
+{
+    Container result;
+
+    if (first.isBitmap() && last.isBitmap()) {
+        result.bits.resize(BitmapWords);
+        for (int i = 0; i < BitmapWords; i++) {
+            result.bits[i] = first.bits.at(i) & last.bits.at(i);
+            result.cardinality += qPopulationCount(result.bits.at(i));
+        }
+
+        if (result.cardinality <= ArrayLimit)
+            toArray(result);
+    } else if (first.isBitmap() || last.isBitmap()) {
+        //Probe the bitmap with every value of the array
+        const Container &array = first.isBitmap() ? last : first;
+        const Container &bitmap = first.isBitmap() ? first : last;
+
+        foreach (quint16 low, array.array)
+            if (bitmap.bits.at(low / 64) & (quint64(1) << (low % 64)))
+                result.array.append(low);
+        result.cardinality = result.array.size();
+    } else {
+        std::set_intersection(first.array.constBegin(), first.array.constEnd(),
+                              last.array.constBegin(), last.array.constEnd(),
+                              std::back_inserter(result.array));
+        result.cardinality = result.array.size();
+    }
+
+    return result;
+}
+
+
+bool RomBitmap::isEmpty() const
+{
+    return containers.isEmpty();
+}
+
+
+void RomBitmap::remove(quint32 value)
+{
+    QMap<quint16, Container>::iterator container = containers.find(value >> 16);
+    if (container == containers.end())
+        return;
+
+    quint16 low = value & 0xFFFF;
+
+    if (container->isBitmap()) {
+        quint64 &word = container->bits[low / 64];
+        quint64 bit = quint64(1) << (low % 64);
+        if (word & bit) {
+            word &= ~bit;
+            container->cardinality--;
+        }
+
+        if (container->cardinality <= ArrayLimit)
+            toArray(*container);
+    } else {
+        QVector<quint16>::iterator position = std::lower_bound(container->array.begin(), container->array.end(), low);
+        if (position != container->array.end() && *position == low) {
+            container->array.erase(position);
+            container->cardinality--;
+        }
+    }
+
+    if (container->cardinality == 0)
+        containers.erase(container);
+}
+
+
+void RomBitmap::toArray(Container &container)
+{
+    container.array.clear();
+    container.array.reserve(container.cardinality);
+
+    for (int i = 0; i < BitmapWords; i++)
+    {
+        quint64 word = container.bits.at(i);
+        for (int bit = 0; word != 0; bit++, word >>= 1)
+            if (word & 1)
+                container.array.append(quint16(i * 64 + bit));
+    }
+
+    container.bits.clear();
+}
+
+
+void RomBitmap::toBitmap(Container &container)
+{
+    container.bits.fill(0, BitmapWords);
+
+    foreach (quint16 low, container.array)
+        container.bits[low / 64] |= quint64(1) << (low % 64);
+
+    container.array.clear();
+}
+
+
+QList<quint32> RomBitmap::toList() const
+{
+    QList<quint32> values;
+
+    for (QMap<quint16, Container>::const_iterator container = containers.constBegin();
+         container != containers.constEnd(); ++container)
+    {
+        quint32 high = quint32(container.key()) << 16;
+
+        if (container->isBitmap()) {
+            Container array = container.value();
+            toArray(array);
+            foreach (quint16 low, array.array)
+                values.append(high | low);
+        } else {
+            foreach (quint16 low, container->array)
+                values.append(high | low);
+        }
+    }
+
+    return values;
+}
+
+
+RomBitmap::Container RomBitmap::unite(const Container &first, const Container &last)
+{
+    Container result;
+
+    if (first.isBitmap() || last.isBitmap()) {
+        result = first.isBitmap() ? first : last;
+        const Container &other = first.isBitmap() ? last : first;
+
+        if (other.isBitmap()) {
+            result.cardinality = 0;
+            for (int i = 0; i < BitmapWords; i++) {
+                result.bits[i] |= other.bits.at(i);
+                result.cardinality += qPopulationCount(result.bits.at(i));
+            }
+        } else {
+            foreach (quint16 low, other.array) {
+                quint64 &word = result.bits[low / 64];
+                quint64 bit = quint64(1) << (low % 64);
+                if (!(word & bit)) {
+                    word |= bit;
+                    result.cardinality++;
+                }
+            }
+        }
+    } else {
+        std::set_union(first.array.constBegin(), first.array.constEnd(),
+                       last.array.constBegin(), last.array.constEnd(),
+                       std::back_inserter(result.array));
+        result.cardinality = result.array.size();
+
+        if (result.cardinality > ArrayLimit)
+            toBitmap(result);
+    }
+
+    return result;
+}
+
+
+RomBitmap RomBitmap::operator&(const RomBitmap &other) const
+{
+    RomBitmap result(*this);
+    result &= other;
+    return result;
+}
+
+
+RomBitmap RomBitmap::operator|(const RomBitmap &other) const
+{
+    RomBitmap result(*this);
+    result |= other;
+    return result;
+}
+
+
+RomBitmap &RomBitmap::operator&=(const RomBitmap &other)
+{
+    QMap<quint16, Container> result;
+
+    //Only containers present on both sides can have values left
+    for (QMap<quint16, Container>::const_iterator container = containers.constBegin();
+         container != containers.constEnd(); ++container)
+    {
+        QMap<quint16, Container>::const_iterator match = other.containers.constFind(container.key());
+        if (match == other.containers.constEnd())
+            continue;
+
+        Container intersection = intersect(container.value(), match.value());
+        if (intersection.cardinality > 0)
+            result.insert(container.key(), intersection);
+    }
+
+    containers.swap(result);
+    return *this;
+}
+
+
+RomBitmap &RomBitmap::operator|=(const RomBitmap &other)
+{
+    for (QMap<quint16, Container>::const_iterator container = other.containers.constBegin();
+         container != other.containers.constEnd(); ++container)
+    {
+        QMap<quint16, Container>::iterator match = containers.find(container.key());
+        if (match == containers.end())
+            containers.insert(container.key(), container.value());
+        else
+            *match = unite(match.value(), container.value());
+    }
+
+    return *this;
+}
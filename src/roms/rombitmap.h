@@ -0,0 +1,80 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef ROMBITMAP_H
+#define ROMBITMAP_H
+
+#include <QList>
+#include <QMap>
+#include <QVector>
+
+
+// Compressed set of 32-bit ROM ids, laid out like a roaring bitmap.
+//
+// Ids are split on their high 16 bits into containers.  A container keeps
+// its low 16 bits as a sorted array while it is sparse and switches to a
+// plain 65536-bit bitmap once it holds more than ArrayLimit values, so
+// both small facet values and ones covering most of the collection stay
+// compact and intersect quickly.
+class RomBitmap
+{
+public:
+    void add(quint32 value);
+    int cardinality() const;
+    bool contains(quint32 value) const;
+    bool isEmpty() const;
+    void remove(quint32 value);
+    QList<quint32> toList() const;
+
+    RomBitmap operator&(const RomBitmap &other) const;
+    RomBitmap operator|(const RomBitmap &other) const;
+    RomBitmap &operator&=(const RomBitmap &other);
+    RomBitmap &operator|=(const RomBitmap &other);
+
+private:
+    struct Container {
+        QVector<quint16> array;
+        QVector<quint64> bits;
+        int cardinality;
+
+        Container() : cardinality(0) {}
+        bool isBitmap() const { return !bits.isEmpty(); }
+    };
+
+    static Container intersect(const Container &first, const Container &last);
+    static Container unite(const Container &first, const Container &last);
+    static void toArray(Container &container);
+    static void toBitmap(Container &container);
+
+    QMap<quint16, Container> containers;
+};
+
+#endif // ROMBITMAP_H
@@ -30,19 +30,19 @@
  ***/
 
 #include "romcollection.h"
+#include "romcollectionmodel.h"
+#include "rommetadata.h"
 #include "../error.h"
 #include "../global.h"
 #include "../common.h"
+#include "../stallwatchdog.h"
 
 #include "thegamesdbscraper.h"
 
 #include <QCoreApplication>
 #include <QCryptographicHash>
 #include <QDir>
-#include <QJsonDocument>
-#include <QJsonObject>
 #include <QProgressDialog>
-#include <QTime>
 
 #include <QtSql/QSqlQuery>
 
@@ -54,8 +54,12 @@ RomCollection::RomCollection(QStringList fileTypes, QStringList romPaths, QWidge
     this->romPaths = romPaths;
     this->romPaths.removeAll("");
     this->parent = parent;
+    this->romCatalog = NULL;
 
     setupDatabase();
+    loadCatalog();
+
+    model = new RomCollectionModel(this, database, this);
 }
 
 
@@ -77,12 +81,34 @@ Rom RomCollection::addRom(QByteArray *romData, QString fileName, QString directo
     currentRom.zipFile = zipFile;
     currentRom.sortSize = romData->size();
 
+    if (!ddRom)
+        initializeRom(&currentRom, false);
+
+    //Stored so the collection can be sorted and paged on it, NULL sorts unknown ROMs last
+    QVariant goodName(QVariant::String);
+    if (!ddRom &&
+        currentRom.goodName != getTranslation("Unknown ROM") &&
+        currentRom.goodName != getTranslation("Requires catalog file"))
+        goodName = currentRom.goodName;
+
+    QString baseName = QFileInfo(currentRom.fileName).completeBaseName();
+
     query.bindValue(":filename",      currentRom.fileName);
+    query.bindValue(":filename_key",  getCollationKey(currentRom.fileName));
+    query.bindValue(":base_name",     baseName);
+    query.bindValue(":base_name_key", getCollationKey(baseName));
     query.bindValue(":directory",     currentRom.directory);
     query.bindValue(":internal_name", currentRom.internalName);
-    query.bindValue(":md5",           currentRom.romMD5);
+    query.bindValue(":internal_name_key", getCollationKey(currentRom.internalName));
+    query.bindValue(":md5",           currentRom.romMD5.toLower());
     query.bindValue(":zip_file",      currentRom.zipFile);
     query.bindValue(":size",          currentRom.sortSize);
+    query.bindValue(":good_name",     goodName);
+    query.bindValue(":good_name_key", goodName.isNull() ? getLastCollationKey()
+                                                        : getCollationKey(goodName.toString()));
+    query.bindValue(":players",       currentRom.players);
+    query.bindValue(":save_type",     currentRom.saveType);
+    query.bindValue(":rumble",        currentRom.rumble);
 
     if (ddRom)
         query.bindValue(":dd_rom", 1);
@@ -91,17 +117,18 @@ Rom RomCollection::addRom(QByteArray *romData, QString fileName, QString directo
 
     query.exec();
 
-    if (!ddRom)
-        initializeRom(&currentRom, false);
-
     return currentRom;
 }
 
 
 int RomCollection::addRoms()
 {
+    StallOperation operation("Scanning ROMs");
+
     emit updateStarted();
 
+    loadCatalog();
+
     //Count files so we know how to setup the progress dialog
     int totalCount = 0;
 
@@ -114,9 +141,6 @@ int RomCollection::addRoms()
         }
     }
 
-    QList<Rom> roms;
-    QList<Rom> ddRoms;
-
     database.open();
     database.transaction();
     QSqlQuery query("DELETE FROM rom_collection", database);
@@ -126,10 +150,15 @@ int RomCollection::addRoms()
         setupProgressDialog(totalCount);
 
         query.prepare(QString("INSERT INTO rom_collection ")
-                      + "(filename, directory, internal_name, md5, zip_file, size, dd_rom) "
-                      + "VALUES (:filename, :directory, :internal_name, :md5, :zip_file, :size, :dd_rom)");
+                      + "(filename, filename_key, base_name, base_name_key, directory, internal_name, "
+                      + "internal_name_key, md5, zip_file, size, good_name, good_name_key, "
+                      + "players, save_type, rumble, dd_rom) "
+                      + "VALUES (:filename, :filename_key, :base_name, :base_name_key, :directory, :internal_name, "
+                      + ":internal_name_key, :md5, :zip_file, :size, :good_name, :good_name_key, "
+                      + ":players, :save_type, :rumble, :dd_rom)");
 
         scraper = new TheGamesDBScraper(parent);
+        connect(scraper, SIGNAL(gameInfoUpdated(QString)), this, SLOT(updateGameInfo(QString)));
 
         foreach (QString romPath, romPaths)
         {
@@ -155,10 +184,10 @@ int RomCollection::addRoms()
                             byteswap(romData);
 
                         if (romData.left(4).toHex() == "80371240") { //Z64 ROM
-                            roms.append(addRom(&romData, zippedFile, romPath, fileName, query));
+                            addRom(&romData, zippedFile, romPath, fileName, query);
                             romCount++;
                         } else if (romData.left(4).toHex() == "e848d316") { //64DD ROM
-                            ddRoms.append(addRom(&romData, zippedFile, romPath, fileName, query, true));
+                            addRom(&romData, zippedFile, romPath, fileName, query, true);
                             romCount++;
                         }
                     }
@@ -170,10 +199,10 @@ int RomCollection::addRoms()
                         byteswap(romData);
 
                     if (romData.left(4).toHex() == "80371240") { //Z64 ROM
-                        roms.append(addRom(&romData, fileName, romPath, "", query));
+                        addRom(&romData, fileName, romPath, "", query);
                         romCount++;
                     } else if (romData.left(4).toHex() == "e848d316") { //64DD ROM
-                        ddRoms.append(addRom(&romData, fileName, romPath, "", query, true));
+                        addRom(&romData, fileName, romPath, "", query, true);
                         romCount++;
                     }
                 }
@@ -187,46 +216,43 @@ int RomCollection::addRoms()
                 SHOW_W(tr("No ROMs found in ") + romPath + ".");
         }
 
-        delete scraper;
+        //Downloads carry on after the scan, the scraper goes once they are done
+        connect(scraper, SIGNAL(finished()), scraper, SLOT(deleteLater()));
+        scraper->closeQueue();
         progress->close();
     } else if (romPaths.size() != 0) {
         SHOW_W(tr("No ROMs found."));
     }
 
     database.commit();
-    database.close();
 
-    //Emit signals for regular roms
-    qSort(roms.begin(), roms.end(), romSorter);
+    //Views receive the ROMs from the model as they scroll
+    reloadModel();
+    emitDDRoms();
 
-    for (int i = 0; i < roms.size(); i++)
-        emit romAdded(&roms[i], i);
+    int romCount = model->getTotalCount();
+    emit updateEnded(romCount);
 
-    //Emit signals for 64DD roms
-    qSort(ddRoms.begin(), ddRoms.end(), romSorter);
-
-    for (int i = 0; i < ddRoms.size(); i++)
-        emit ddRomAdded(&ddRoms[i]);
-
-    emit updateEnded(roms.size());
-
-    return roms.size();
+    return romCount;
 }
 
 
 int RomCollection::cachedRoms(bool imageUpdated, bool onStartup)
 {
+    StallOperation operation("Loading cached ROMs");
+
     emit updateStarted(imageUpdated);
 
+    loadCatalog();
+
     database.open();
-    QSqlQuery query(QString("SELECT filename, directory, md5, internal_name, zip_file, size, dd_rom ")
-                    + "FROM rom_collection", database);
+    QSqlQuery query("SELECT COUNT(*) FROM rom_collection", database);
+    query.next();
 
-    query.last();
-    int romCount = query.at() + 1;
-    query.seek(-1);
+    int romCount = query.value(0).toInt();
+    query.finish();
 
-    if (romCount == -1) //Nothing cached so try adding ROMs instead
+    if (romCount == 0) //Nothing cached so try adding ROMs instead
         return addRoms();
 
 
@@ -235,7 +261,7 @@ int RomCollection::cachedRoms(bool imageUpdated, bool onStartup)
         bool onV1 = false;
         QDir cacheDir(getCacheLocation());
 
-        if (!cacheDir.exists() && SETTINGS.value("Other/downloadinfo", "").toString() == "true")
+        if (!cacheDir.exists() && CACHED_SETTINGS.downloadInfo)
             onV1 = true;
 
         if (onV1)
@@ -243,12 +269,26 @@ int RomCollection::cachedRoms(bool imageUpdated, bool onStartup)
     }
 
 
-    QList<Rom> roms;
-    QList<Rom> ddRoms;
+    //Only the first page is read here, the rest is fetched as views scroll
+    reloadModel();
+    emitDDRoms();
 
-    int count = 0;
-    bool showProgress = false;
-    QTime checkPerformance;
+    romCount = model->getTotalCount();
+    emit updateEnded(romCount, true);
+
+    return romCount;
+}
+
+
+void RomCollection::emitDDRoms()
+{
+    if (!database.isOpen())
+        database.open();
+
+    QSqlQuery query(QString("SELECT filename, directory, md5, internal_name, zip_file, size ")
+                    + "FROM rom_collection WHERE dd_rom = 1 ORDER BY filename", database);
+
+    QList<Rom> ddRoms;
 
     while (query.next())
     {
@@ -260,56 +300,12 @@ int RomCollection::cachedRoms(bool imageUpdated, bool onStartup)
         currentRom.internalName = query.value(3).toString();
         currentRom.zipFile = query.value(4).toString();
         currentRom.sortSize = query.value(5).toInt();
-        int ddRom = query.value(6).toInt();
-
-        //Check performance of adding first item to see if progress dialog needs to be shown
-        if (count == 0) checkPerformance.start();
 
-        if (ddRom == 1)
-            ddRoms.append(currentRom);
-        else {
-            initializeRom(&currentRom, true);
-            roms.append(currentRom);
-        }
-
-        if (count == 0) {
-            int runtime = checkPerformance.elapsed();
-
-            //check if operation expected to take longer than two seconds
-            if (runtime * romCount > 2000) {
-                setupProgressDialog(romCount);
-                showProgress = true;
-            }
-        }
-
-        count++;
-
-        if (showProgress) {
-            progress->setValue(count);
-            QCoreApplication::processEvents(QEventLoop::AllEvents);
-        }
+        ddRoms.append(currentRom);
     }
 
-    database.close();
-
-    if (showProgress)
-        progress->close();
-
-    //Emit signals for regular roms
-    qSort(roms.begin(), roms.end(), romSorter);
-
-    for (int i = 0; i < roms.size(); i++)
-        emit romAdded(&roms[i], i);
-
-    //Emit signals for 64DD roms
-    qSort(ddRoms.begin(), ddRoms.end(), romSorter);
-
     for (int i = 0; i < ddRoms.size(); i++)
         emit ddRomAdded(&ddRoms[i]);
-
-    emit updateEnded(roms.size(), true);
-
-    return roms.size();
 }
 
 
@@ -324,30 +320,48 @@ QStringList RomCollection::getFileTypes(bool archives)
 }
 
 
-void RomCollection::initializeRom(Rom *currentRom, bool cached)
+RomCollectionModel *RomCollection::getModel()
 {
-    QSettings *romCatalog = new QSettings(parent);
+    return model;
+}
 
-    QString catalogFile = SETTINGS.value("Paths/catalog", "").toString();
-    if (catalogFile == "") {
-        QString dataPath = SETTINGS.value("Paths/data", "").toString();
-        QDir dataDir(dataPath);
 
-        if (QFileInfo(dataDir.absoluteFilePath("mupen64plus.ini")).exists())
-            catalogFile = dataDir.absoluteFilePath("mupen64plus.ini");
-    }
+int RomCollection::importGameInfo(QString fileName)
+{
+    StallOperation operation("Importing game info");
+
+    database.open();
+    QSqlQuery query("SELECT md5, good_name, internal_name FROM rom_collection WHERE dd_rom = 0", database);
+
+    QHash<QString, QString> searchNames;
+    while (query.next())
+        searchNames.insert(query.value(0).toString(),
+                           getSearchName(query.value(1).toString(), query.value(2).toString()));
+    query.finish();
 
+    //One transaction for the whole library rather than one per ROM
+    database.transaction();
+
+    TheGamesDBScraper importer(parent);
+    int found = importer.importGameInfo(fileName, searchNames);
+
+    database.commit();
+
+    if (found > 0)
+        cachedRoms(true);
+
+    return found;
+}
+
+
+void RomCollection::initializeRom(Rom *currentRom, bool cached)
+{
     QDir romDir(currentRom->directory);
 
     //Default text for GoodName to notify user
     currentRom->goodName = getTranslation("Requires catalog file");
-    currentRom->imageExists = false;
 
-    bool getGoodName = false;
-    if (QFileInfo(catalogFile).exists()) {
-        romCatalog = new QSettings(catalogFile, QSettings::IniFormat, parent);
-        getGoodName = true;
-    }
+    bool getGoodName = romCatalog != NULL;
 
     QFile file(romDir.absoluteFilePath(currentRom->fileName));
 
@@ -376,59 +390,111 @@ void RomCollection::initializeRom(Rom *currentRom, bool cached)
         currentRom->rumble = romCatalog->value(newMD5+"/Rumble","").toString();
     }
 
-    if (!cached && SETTINGS.value("Other/downloadinfo", "").toString() == "true") {
-        if (currentRom->goodName != getTranslation("Unknown ROM") &&
-            currentRom->goodName != getTranslation("Requires catalog file")) {
-            scraper->downloadGameInfo(currentRom->romMD5, currentRom->goodName);
-        } else {
-            //tweak internal name by adding spaces to get better results
-            QString search = currentRom->internalName;
-            search.replace(QRegExp("([a-z])([A-Z])"),"\\1 \\2");
-            search.replace(QRegExp("([^ \\d])(\\d)"),"\\1 \\2");
-            scraper->downloadGameInfo(currentRom->romMD5, search);
-        }
+    if (!cached && CACHED_SETTINGS.downloadInfo)
+        scraper->queueGameInfo(currentRom->romMD5, getSearchName(currentRom->goodName, currentRom->internalName));
+
+    if (CACHED_SETTINGS.downloadInfo) {
+        RomMetadata metadata;
+        RomMetadataStore::instance()->find(currentRom->romMD5, &metadata);
+
+        currentRom->gameTitle = metadata.gameTitle;
+        if (currentRom->gameTitle == "") currentRom->gameTitle = getTranslation("Not found");
 
+        currentRom->releaseDate = metadata.releaseDate;
+        currentRom->sortDate = metadata.sortDate;
+        currentRom->overview = metadata.overview;
+        currentRom->esrb = metadata.rating;
+
+        currentRom->genre = metadata.genres;
+        currentRom->publisher = metadata.publisher;
+        currentRom->developer = metadata.developer;
     }
+}
 
-    if (SETTINGS.value("Other/downloadinfo", "").toString() == "true") {
-        QString dataFile = getCacheLocation() + currentRom->romMD5.toLower() + "/data.json";
-        QFile file(dataFile);
 
-        file.open(QIODevice::ReadOnly);
-        QString data = file.readAll();
-        file.close();
+QString RomCollection::getSearchName(QString goodName, QString internalName)
+{
+    if (goodName != "" &&
+        goodName != getTranslation("Unknown ROM") &&
+        goodName != getTranslation("Requires catalog file"))
+        return goodName;
 
-        QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
-        QJsonObject json = document.object();
+    //tweak internal name by adding spaces to get better results
+    QString search = internalName;
+    search.replace(QRegExp("([a-z])([A-Z])"),"\\1 \\2");
+    search.replace(QRegExp("([^ \\d])(\\d)"),"\\1 \\2");
 
-        //Remove any non-standard characters
-        QString regex = "[^A-Za-z 0-9 \\.,\\?'""!@#\\$%\\^&\\*\\(\\)-_=\\+;:<>\\/\\\\|\\}\\{\\[\\]`~é]*";
+    return search;
+}
 
-        currentRom->gameTitle = json.value("game_title").toString().remove(QRegExp(regex));
-        if (currentRom->gameTitle == "") currentRom->gameTitle = getTranslation("Not found");
 
-        currentRom->releaseDate = json.value("release_date").toString();
-        currentRom->sortDate = json.value("release_date").toString();
-        currentRom->releaseDate.replace(QRegExp("(\\d{4})-(\\d{2})-(\\d{2})"), "\\2/\\3/\\1");
+void RomCollection::getSortSetting(QString &sort, bool &descending)
+{
+    QString direction = "ascending";
+    QString layout = CACHED_SETTINGS.viewLayout;
+
+    sort = "Filename";
+
+    if (layout == "grid") {
+        sort = CACHED_SETTINGS.gridSort;
+        direction = CACHED_SETTINGS.gridSortDirection;
+    } else if (layout == "list") {
+        sort = CACHED_SETTINGS.listSort;
+        direction = CACHED_SETTINGS.listSortDirection;
+    } else if (layout == "table") {
+        //Page in the order of the table header so loaded rows stay contiguous
+        QStringList tableSort = CACHED_SETTINGS.tableSort.split("|");
+        if (tableSort.size() == 2) {
+            sort = tableSort[0];
+            direction = tableSort[1];
+        }
+    }
 
-        currentRom->overview = json.value("overview").toString().remove(QRegExp(regex));
-        currentRom->esrb = json.value("rating").toString();
+    descending = direction == "descending";
+}
 
-        currentRom->genre = json.value("genres").toString();
-        currentRom->publisher = json.value("publisher").toString();
-        currentRom->developer = json.value("developer").toString();
 
-        foreach (QString ext, QStringList() << "jpg" << "png")
-        {
-            QString imageFile = getCacheLocation() + currentRom->romMD5.toLower() + "/boxart-front." + ext;
-            QFile cover(imageFile);
+void RomCollection::loadCatalog()
+{
+    //Opened once per scan or reload, ROMs are resolved again whenever views scroll back
+    QString catalogFile = SETTINGS.value("Paths/catalog", "").toString();
+    if (catalogFile == "") {
+        QString dataPath = SETTINGS.value("Paths/data", "").toString();
+        QDir dataDir(dataPath);
 
-            if (cover.exists() && currentRom->image.load(imageFile)) {
-                currentRom->imageExists = true;
-                break;
-            }
-        }
+        if (QFileInfo(dataDir.absoluteFilePath("mupen64plus.ini")).exists())
+            catalogFile = dataDir.absoluteFilePath("mupen64plus.ini");
     }
+
+    delete romCatalog;
+    romCatalog = NULL;
+
+    if (QFileInfo(catalogFile).exists())
+        romCatalog = new QSettings(catalogFile, QSettings::IniFormat, this);
+}
+
+
+void RomCollection::reloadModel()
+{
+    QString sort;
+    bool descending;
+
+    getSortSetting(sort, descending);
+    model->reload(sort, descending);
+}
+
+
+void RomCollection::resolveRom(Rom *currentRom)
+{
+    initializeRom(currentRom, true);
+}
+
+
+void RomCollection::setDownloadsPaused(bool pause)
+{
+    //Only the scraper of a scan keeps downloading in the background, it is gone once done
+    if (scraper != NULL)
+        scraper->setPaused(pause);
 }
 
 
@@ -452,7 +518,7 @@ void RomCollection::setupDatabase()
 {
     // Bump this when updating rom_collection structure
     // Will cause clients to delete and recreate the table
-    int dbVersion = 2;
+    int dbVersion = 6;
 
     database = QSqlDatabase::addDatabase("QSQLITE");
     database.setDatabaseName(getDataLocation() + "/"+AppNameLower+".sqlite");
@@ -476,13 +542,32 @@ void RomCollection::setupDatabase()
                     + "CREATE TABLE IF NOT EXISTS rom_collection ("
                         + "rom_id INTEGER PRIMARY KEY ASC, "
                         + "filename TEXT NOT NULL, "
+                        + "filename_key TEXT NOT NULL, "
+                        + "base_name TEXT NOT NULL, "
+                        + "base_name_key TEXT NOT NULL, "
                         + "directory TEXT NOT NULL, "
                         + "md5 TEXT NOT NULL, "
                         + "internal_name TEXT, "
+                        + "internal_name_key TEXT, "
                         + "zip_file TEXT, "
                         + "size INTEGER, "
+                        + "good_name TEXT, "
+                        + "good_name_key TEXT NOT NULL, "
+                        + "players TEXT, "
+                        + "save_type TEXT, "
+                        + "rumble TEXT, "
                         + "dd_rom INTEGER)");
 
+    //Indexes for the sort orders RomCollectionModel pages on
+    database.exec("CREATE INDEX IF NOT EXISTS rom_filename ON rom_collection (dd_rom, filename_key)");
+    database.exec("CREATE INDEX IF NOT EXISTS rom_base_name ON rom_collection (dd_rom, base_name_key)");
+    database.exec("CREATE INDEX IF NOT EXISTS rom_good_name ON rom_collection (dd_rom, good_name_key)");
+    database.exec("CREATE INDEX IF NOT EXISTS rom_internal_name ON rom_collection (dd_rom, internal_name_key)");
+    database.exec("CREATE INDEX IF NOT EXISTS rom_size ON rom_collection (dd_rom, size)");
+    database.exec("CREATE INDEX IF NOT EXISTS rom_md5 ON rom_collection (dd_rom, md5)");
+
+    RomMetadataStore::instance()->setup(database);
+
     database.close();
 }
 
@@ -504,6 +589,25 @@ void RomCollection::setupProgressDialog(int size)
 }
 
 
+void RomCollection::updateSort()
+{
+    StallOperation operation("Sorting ROMs");
+
+    QString sort;
+    bool descending;
+
+    getSortSetting(sort, descending);
+    model->setSort(sort, descending);
+}
+
+
+void RomCollection::updateGameInfo(QString identifier)
+{
+    //Views drop the cover they had and resolve the row again
+    model->updateRom(identifier);
+}
+
+
 void RomCollection::updatePaths(QStringList romPaths)
 {
     this->romPaths = romPaths;
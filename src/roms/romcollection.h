@@ -33,11 +33,14 @@
 #define ROMCOLLECTION_H
 
 #include <QObject>
+#include <QPointer>
 #include <QStringList>
 #include <QtSql/QSqlDatabase>
 
 class QDir;
 class QProgressDialog;
+class QSettings;
+class RomCollectionModel;
 class TheGamesDBScraper;
 struct Rom;
 
@@ -48,9 +51,14 @@ class RomCollection : public QObject
 public:
     explicit RomCollection(QStringList fileTypes, QStringList romPaths, QWidget *parent = 0);
     int cachedRoms(bool imageUpdated = false, bool onStartup = false);
+    int importGameInfo(QString fileName);
+    void resolveRom(Rom *currentRom);
+    void setDownloadsPaused(bool pause);
     void updatePaths(QStringList romPaths);
+    void updateSort();
 
     QStringList getFileTypes(bool archives = false);
+    RomCollectionModel *getModel();
     QStringList romPaths;
 
 public slots:
@@ -58,12 +66,16 @@ public slots:
 
 signals:
     void ddRomAdded(Rom *currentRom);
-    void romAdded(Rom *currentRom, int count);
     void updateEnded(int romCount, bool cached = false);
     void updateStarted(bool imageUpdated = false);
 
 private:
+    void emitDDRoms();
+    static QString getSearchName(QString goodName, QString internalName);
+    void getSortSetting(QString &sort, bool &descending);
     void initializeRom(Rom *currentRom, bool cached);
+    void loadCatalog();
+    void reloadModel();
     void setupDatabase();
     void setupProgressDialog(int size);
 
@@ -75,9 +87,14 @@ private:
 
     QWidget *parent;
     QProgressDialog *progress;
+    QSettings *romCatalog;
     QSqlDatabase database;
 
-    TheGamesDBScraper *scraper;
+    RomCollectionModel *model;
+    QPointer<TheGamesDBScraper> scraper;
+
+private slots:
+    void updateGameInfo(QString identifier);
 };
 
 #endif // ROMCOLLECTION_H
@@ -0,0 +1,755 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "romcollectionmodel.h"
+#include "parallelsort.h"
+#include "romcollection.h"
+#include "rommetadata.h"
+#include "../global.h"
+#include "../stallwatchdog.h"
+
+#include <QHash>
+#include <QtSql/QSqlQuery>
+
+#include <algorithm>
+
+
+// Rows read from the database per fetchMore() call
+static const int PageSize = 128;
+
+// Rows on either side of the viewport that keep their resolved data
+static const int WindowSize = 256;
+
+static const QString Columns = "rom_id, filename, directory, md5, internal_name, zip_file, size, good_name, "
+                               "base_name, players, save_type, rumble";
+
+
+// Returns the SQL expression that orders ROMs by the given sort setting,
+// or an empty string when the field isn't stored in the database.
+// Each expression is backed by an index created in setupDatabase().
+static QString getSortExpression(RomFieldId sort)
+{
+    switch (sort) {
+    case FilenameField:
+        return "base_name_key"; //Keeps .z64, .n64 and .v64 copies of a game together
+    case FilenameExtensionField:
+        return "filename_key";
+    case GoodNameField:
+        return "good_name_key"; //Unknown ROMs have the last key
+    case InternalNameField:
+        return "internal_name_key";
+    case SizeField:
+        return "size";
+    case MD5Field:
+        return "md5";
+    default:
+        return "";
+    }
+}
+
+
+RomCollectionModel::RomCollectionModel(RomCollection *collection, QSqlDatabase database, QObject *parent)
+    : QAbstractListModel(parent)
+{
+    this->collection = collection;
+    this->database = database;
+
+    setSortField("Filename", false);
+    totalCount = 0;
+}
+
+
+bool RomCollectionModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return false;
+
+    return entries.size() < totalCount;
+}
+
+
+QVariant RomCollectionModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= entries.size())
+        return QVariant();
+
+    //Stored columns are there without resolving the row
+    const Rom &stored = entries[index.row()].rom;
+
+    switch (role) {
+    case FileNameRole:
+        return stored.fileName;
+    case DirectoryRole:
+        return stored.directory;
+    case MD5Role:
+        return stored.romMD5.toUpper();
+    case ZipFileRole:
+        return stored.zipFile;
+    }
+
+    const Rom *rom = getRom(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return getRomInfo(sortField, rom);
+    case SearchRole:
+        if (rom->goodName == getTranslation("Unknown ROM") ||
+            rom->goodName == getTranslation("Requires catalog file"))
+            return rom->internalName;
+        return rom->goodName;
+    }
+
+    return QVariant();
+}
+
+
+void RomCollectionModel::fetchAll()
+{
+    QSqlQuery query("SELECT " + Columns + ", NULL FROM rom_collection WHERE dd_rom = 0", database);
+
+    QVector<Entry> result;
+    readEntries(query, result);
+
+    //Rows added one at a time by insertRom() are in the model already
+    QSet<qint64> loaded;
+    foreach (const Entry &entry, entries)
+        loaded.insert(entry.id);
+
+    QVector<Entry> added;
+    foreach (const Entry &entry, result)
+        if (!loaded.contains(entry.id))
+            added.append(entry);
+
+    //This is the whole collection, whatever the count said when it was taken
+    totalCount = entries.size() + added.size();
+
+    if (added.isEmpty())
+        return;
+
+    //Field isn't in the database so resolve everything and sort in memory
+    sortEntries(added);
+
+    foreach (const Entry &entry, added)
+        indexEntry(entry);
+
+    bool merge = !entries.isEmpty();
+
+    beginInsertRows(QModelIndex(), entries.size(), entries.size() + added.size() - 1);
+    entries += added;
+    updateResolvedRows();
+    endInsertRows();
+
+    if (merge)
+        sortRows();
+}
+
+
+void RomCollectionModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    if (!database.isOpen())
+        database.open();
+
+    if (sortExpression == "") {
+        fetchAll();
+        return;
+    }
+
+    QString direction = descending ? "DESC" : "ASC";
+    QString compare = descending ? "<" : ">";
+
+    QString queryString = "SELECT " + Columns + ", " + sortExpression + " FROM rom_collection WHERE dd_rom = 0 ";
+
+    //Continue after the last key instead of using OFFSET, so every page is an index range scan
+    if (!entries.isEmpty())
+        queryString += "AND " + sortExpression + " " + compare + "= ? "
+                     + "AND (" + sortExpression + " " + compare + " ? OR rom_id " + compare + " ?) ";
+
+    queryString += "ORDER BY " + sortExpression + " " + direction + ", rom_id " + direction + " LIMIT ?";
+
+    QSqlQuery query(database);
+    query.prepare(queryString);
+
+    if (!entries.isEmpty()) {
+        const Entry &last = entries.last();
+        query.addBindValue(last.sortKey);
+        query.addBindValue(last.sortKey);
+        query.addBindValue(last.id);
+    }
+    query.addBindValue(PageSize);
+    query.exec();
+
+    QVector<Entry> page;
+    readEntries(query, page);
+
+    if (page.isEmpty()) { //Collection changed underneath us
+        totalCount = entries.size();
+        return;
+    }
+
+    foreach (const Entry &entry, page)
+        indexEntry(entry);
+
+    beginInsertRows(QModelIndex(), entries.size(), entries.size() + page.size() - 1);
+    entries += page;
+    endInsertRows();
+
+    //A short page is the last one, even if the count said there were more
+    if (page.size() < PageSize)
+        totalCount = entries.size();
+}
+
+
+QMap<QString, int> RomCollectionModel::getFacetCounts(QString field) const
+{
+    return facetIndex.getCounts(field, facetFilter);
+}
+
+
+QStringList RomCollectionModel::getFacetFilter(QString field) const
+{
+    return facetFilter.value(field);
+}
+
+
+const Rom *RomCollectionModel::getRom(int row) const
+{
+    if (row < 0 || row >= entries.size())
+        return NULL;
+
+    if (!entries[row].resolved)
+        resolveEntry(row);
+
+    return &entries[row].rom;
+}
+
+
+int RomCollectionModel::getRoleFromName(QString infoName)
+{
+    //Same names as the properties the widget based views used
+    if (infoName == "fileName")
+        return FileNameRole;
+    else if (infoName == "directory" || infoName == "dirName")
+        return DirectoryRole;
+    else if (infoName == "search")
+        return SearchRole;
+    else if (infoName == "romMD5")
+        return MD5Role;
+    else if (infoName == "zipFile")
+        return ZipFileRole;
+
+    return FileNameRole;
+}
+
+
+RomCollectionModel::SortItem RomCollectionModel::getSortItem(const Entry &entry, int index) const
+{
+    SortItem item;
+
+    if (numericSort)
+        item.number = entry.sortKey.toLongLong();
+    else {
+        item.text = entry.sortKey.toString();
+        item.number = 0;
+    }
+    item.id = entry.id;
+    item.index = index;
+
+    return item;
+}
+
+
+QVariant RomCollectionModel::getSortKey(const Entry &entry) const
+{
+    const Rom &rom = entry.rom;
+
+    //Same values as the SQL expressions so loaded and fetched rows agree
+    switch (sortField) {
+    case FilenameField:
+        return getCollationKey(rom.baseName);
+    case FilenameExtensionField:
+        return getCollationKey(rom.fileName);
+    case GoodNameField:
+        return entry.storedGoodName == "" ? getLastCollationKey() : getCollationKey(entry.storedGoodName);
+    case InternalNameField:
+        return getCollationKey(rom.internalName);
+    case SizeField:
+        return rom.sortSize;
+    case MD5Field:
+        return rom.romMD5.toLower();
+    case ReleaseDateField:
+        return rom.sortDate;
+    default: {
+        //Warnings such as "Not found" sort after every value
+        QString text = getRomInfo(sortField, &rom);
+        return isRomInfoWarning(text) ? getLastCollationKey() : getCollationKey(text);
+    }
+    }
+}
+
+
+int RomCollectionModel::getTotalCount() const
+{
+    return totalCount;
+}
+
+
+void RomCollectionModel::insertRom(qint64 id)
+{
+    if (!database.isOpen())
+        database.open();
+
+    QSqlQuery query(database);
+    query.prepare("SELECT " + Columns + ", NULL FROM rom_collection WHERE rom_id = ? AND dd_rom = 0");
+    query.addBindValue(id);
+    query.exec();
+
+    QVector<Entry> result;
+    readEntries(query, result);
+
+    if (result.isEmpty())
+        return;
+
+    Entry &entry = result[0];
+    if (sortExpression == "") {
+        collection->resolveRom(&entry.rom);
+        entry.resolved = true;
+    }
+    entry.sortKey = getSortKey(entry);
+    indexEntry(entry);
+
+    QVector<Entry>::iterator position = std::lower_bound(entries.begin(), entries.end(), entry,
+        [this](const Entry &first, const Entry &last) { return lessThan(first, last); });
+    int row = position - entries.begin();
+
+    bool partial = canFetchMore(QModelIndex());
+    totalCount++;
+
+    //Belongs to a page that hasn't been fetched yet
+    if (partial && row == entries.size())
+        return;
+
+    beginInsertRows(QModelIndex(), row, row);
+    entries.insert(row, entry);
+    updateResolvedRows();
+    endInsertRows();
+}
+
+
+void RomCollectionModel::indexEntry(const Entry &entry) const
+{
+    //Rows are indexed as soon as their page is read, so searches and facets don't depend on
+    //which rows have been displayed.  The catalog fields are stored with the row and game info
+    //is in memory, so nothing is resolved for it.
+    Rom rom = entry.rom;
+
+    RomMetadata metadata;
+    if (!entry.resolved && CACHED_SETTINGS.downloadInfo &&
+        RomMetadataStore::instance()->find(rom.romMD5, &metadata)) {
+        rom.gameTitle = metadata.gameTitle;
+        rom.sortDate = metadata.sortDate;
+        rom.esrb = metadata.rating;
+        rom.genre = metadata.genres;
+        rom.publisher = metadata.publisher;
+        rom.developer = metadata.developer;
+    }
+
+    QStringList fields;
+
+    fields << entry.storedGoodName << rom.fileName << rom.internalName;
+
+    //Differs when the catalog changed since the scan
+    if (rom.goodName != "" && rom.goodName != entry.storedGoodName &&
+        rom.goodName != getTranslation("Unknown ROM") &&
+        rom.goodName != getTranslation("Requires catalog file"))
+        fields << rom.goodName;
+    if (rom.gameTitle != "" && rom.gameTitle != getTranslation("Not found"))
+        fields << rom.gameTitle;
+
+    searchIndex.insert(entry.id, fields);
+
+    if (filterText != "") {
+        if (searchIndex.matches(entry.id, filterText))
+            filterMatches.insert(entry.id);
+        else
+            filterMatches.remove(entry.id);
+    }
+
+    facetIndex.insert(quint32(entry.id), rom);
+
+    if (!facetFilter.isEmpty()) {
+        if (facetIndex.matches(quint32(entry.id), facetFilter))
+            facetMatches.add(quint32(entry.id));
+        else
+            facetMatches.remove(quint32(entry.id));
+    }
+}
+
+
+bool RomCollectionModel::isFiltered() const
+{
+    return filterText != "" || !facetFilter.isEmpty();
+}
+
+
+bool RomCollectionModel::isRowVisible(int row) const
+{
+    if (row < 0 || row >= entries.size())
+        return false;
+
+    qint64 id = entries[row].id;
+
+    if (filterText != "" && !filterMatches.contains(id))
+        return false;
+
+    return facetFilter.isEmpty() || facetMatches.contains(quint32(id));
+}
+
+
+bool RomCollectionModel::lessThan(const Entry &first, const Entry &last) const
+{
+    return lessThan(getSortItem(first, 0), getSortItem(last, 0));
+}
+
+
+bool RomCollectionModel::lessThan(const SortItem &first, const SortItem &last) const
+{
+    int compare;
+
+    if (numericSort)
+        compare = first.number < last.number ? -1 : (first.number > last.number ? 1 : 0);
+    else
+        compare = QString::compare(first.text, last.text); //Keys are folded already, binary like SQLite
+
+    if (compare == 0) //Same tie-break as ORDER BY key, rom_id
+        compare = first.id < last.id ? -1 : (first.id > last.id ? 1 : 0);
+
+    return descending ? compare > 0 : compare < 0;
+}
+
+
+void RomCollectionModel::loadAll()
+{
+    if (!canFetchMore(QModelIndex()))
+        return;
+
+    StallOperation operation("Indexing ROMs");
+
+    //Every page is read and indexed, rows are still only resolved when displayed
+    while (canFetchMore(QModelIndex()))
+        fetchMore(QModelIndex());
+}
+
+
+void RomCollectionModel::readEntries(QSqlQuery &query, QVector<Entry> &result)
+{
+    while (query.next())
+    {
+        Entry entry;
+
+        entry.id = query.value(0).toLongLong();
+        entry.rom.fileName = query.value(1).toString();
+        entry.rom.directory = query.value(2).toString();
+        entry.rom.romMD5 = query.value(3).toString();
+        entry.rom.internalName = query.value(4).toString();
+        entry.rom.zipFile = query.value(5).toString();
+        entry.rom.sortSize = query.value(6).toInt();
+        entry.storedGoodName = query.value(7).toString();
+        entry.rom.baseName = query.value(8).toString();
+        entry.rom.players = query.value(9).toString();
+        entry.rom.saveType = query.value(10).toString();
+        entry.rom.rumble = query.value(11).toString();
+        entry.sortKey = query.value(12);
+        entry.resolved = false;
+
+        result.append(entry);
+    }
+}
+
+
+void RomCollectionModel::releaseEntry(Entry &entry)
+{
+    //Keep the cheap columns but drop the scraped info, resolving reads it again
+    Rom rom;
+    rom.fileName = entry.rom.fileName;
+    rom.baseName = entry.rom.baseName;
+    rom.directory = entry.rom.directory;
+    rom.romMD5 = entry.rom.romMD5;
+    rom.internalName = entry.rom.internalName;
+    rom.zipFile = entry.rom.zipFile;
+    rom.sortSize = entry.rom.sortSize;
+    rom.players = entry.rom.players;
+    rom.saveType = entry.rom.saveType;
+    rom.rumble = entry.rom.rumble;
+    rom.count = entry.rom.count;
+
+    entry.rom = rom;
+    entry.resolved = false;
+}
+
+
+void RomCollectionModel::releaseRows()
+{
+    foreach (int row, resolvedRows)
+        releaseEntry(entries[row]);
+
+    resolvedRows.clear();
+}
+
+
+void RomCollectionModel::reload(QString sort, bool descending)
+{
+    beginResetModel();
+
+    entries.clear();
+    resolvedRows.clear();
+    searchIndex.clear();
+    filterMatches.clear();
+    facetIndex.clear();
+    facetMatches = RomBitmap();
+
+    setSortField(sort, descending);
+
+    if (!database.isOpen())
+        database.open();
+
+    QSqlQuery count("SELECT COUNT(*) FROM rom_collection WHERE dd_rom = 0", database);
+    count.next();
+    totalCount = count.value(0).toInt();
+
+    endResetModel();
+
+    if (isFiltered())
+        updateFilter();
+    else
+        fetchMore(QModelIndex());
+}
+
+
+void RomCollectionModel::removeRom(QString md5)
+{
+    for (int row = entries.size() - 1; row >= 0; row--)
+    {
+        if (entries[row].rom.romMD5.compare(md5, Qt::CaseInsensitive) == 0) {
+            searchIndex.remove(entries[row].id);
+            filterMatches.remove(entries[row].id);
+            facetIndex.remove(quint32(entries[row].id));
+            facetMatches.remove(quint32(entries[row].id));
+
+            beginRemoveRows(QModelIndex(), row, row);
+            entries.remove(row);
+            totalCount--;
+            updateResolvedRows();
+            endRemoveRows();
+        }
+    }
+}
+
+
+void RomCollectionModel::resolveEntry(int row) const
+{
+    Entry &entry = entries[row];
+
+    collection->resolveRom(&entry.rom);
+    entry.resolved = true;
+    resolvedRows.insert(row);
+
+    indexEntry(entry);
+}
+
+
+void RomCollectionModel::setFacetFilter(QString field, QStringList values)
+{
+    if (facetFilter.value(field) == values)
+        return;
+
+    if (values.isEmpty())
+        facetFilter.remove(field);
+    else
+        facetFilter.insert(field, values);
+
+    updateFilter();
+}
+
+
+void RomCollectionModel::setFilter(QString text)
+{
+    text = text.trimmed();
+    if (text == filterText)
+        return;
+
+    filterText = text;
+    updateFilter();
+}
+
+
+void RomCollectionModel::setSort(QString sort, bool descending)
+{
+    if (sort == this->sort && descending == this->descending)
+        return;
+
+    //Only part of the collection is loaded, so the new order has to come from the database
+    if (canFetchMore(QModelIndex())) {
+        reload(sort, descending);
+        return;
+    }
+
+    setSortField(sort, descending);
+    sortRows();
+}
+
+
+void RomCollectionModel::setSortField(QString sort, bool descending)
+{
+    this->sort = sort;
+    this->sortField = getRomFieldId(sort);
+    this->sortExpression = getSortExpression(sortField);
+    this->descending = descending;
+
+    numericSort = sortField != InvalidField && getRomField(sortField).sortKind == NumberSort;
+}
+
+
+void RomCollectionModel::setViewport(int first, int last)
+{
+    int keepFirst = first - WindowSize;
+    int keepLast = last + WindowSize;
+
+    QList<int> release;
+    foreach (int row, resolvedRows)
+        if (row < keepFirst || row > keepLast)
+            release << row;
+
+    foreach (int row, release) {
+        releaseEntry(entries[row]);
+        resolvedRows.remove(row);
+    }
+}
+
+
+void RomCollectionModel::sortEntries(QVector<Entry> &list) const
+{
+    //Compute every key once up front, then only move small key/index pairs around
+    QVector<SortItem> items(list.size());
+
+    for (int i = 0; i < list.size(); i++) {
+        if (sortExpression == "" && !list[i].resolved) {
+            collection->resolveRom(&list[i].rom);
+            list[i].resolved = true;
+            indexEntry(list[i]);
+        }
+        list[i].sortKey = getSortKey(list[i]);
+        items[i] = getSortItem(list[i], i);
+    }
+
+    parallelStableSort(items, [this](const SortItem &first, const SortItem &last) {
+        return lessThan(first, last);
+    });
+
+    QVector<Entry> sorted;
+    sorted.reserve(list.size());
+    foreach (const SortItem &item, items)
+        sorted.append(list[item.index]);
+
+    list.swap(sorted);
+}
+
+
+void RomCollectionModel::sortRows()
+{
+    emit layoutAboutToBeChanged();
+
+    QHash<qint64, int> oldRows;
+    for (int row = 0; row < entries.size(); row++)
+        oldRows.insert(entries[row].id, row);
+
+    sortEntries(entries);
+    updateResolvedRows();
+
+    QVector<int> newRows(entries.size());
+    for (int row = 0; row < entries.size(); row++)
+        newRows[oldRows.value(entries[row].id)] = row;
+
+    foreach (QModelIndex oldIndex, persistentIndexList())
+        changePersistentIndex(oldIndex, index(newRows.value(oldIndex.row())));
+
+    emit layoutChanged();
+}
+
+
+void RomCollectionModel::updateFilter()
+{
+    StallOperation operation("Filtering ROMs");
+
+    filterMatches.clear();
+    facetMatches = RomBitmap();
+
+    //A search covers the whole collection, not just the pages seen so far
+    if (isFiltered())
+        loadAll();
+
+    if (filterText != "")
+        filterMatches = searchIndex.search(filterText);
+
+    if (!facetFilter.isEmpty())
+        facetMatches = facetIndex.select(facetFilter);
+
+    emit filterChanged();
+}
+
+
+void RomCollectionModel::updateResolvedRows()
+{
+    resolvedRows.clear();
+
+    for (int row = 0; row < entries.size(); row++)
+        if (entries[row].resolved)
+            resolvedRows.insert(row);
+}
+
+
+void RomCollectionModel::updateRom(QString md5)
+{
+    for (int row = 0; row < entries.size(); row++)
+    {
+        if (entries[row].rom.romMD5.compare(md5, Qt::CaseInsensitive) == 0) {
+            //Game info changed, so the search terms may have too
+            if (entries[row].resolved)
+                resolveEntry(row);
+            else
+                indexEntry(entries[row]);
+
+            emit dataChanged(index(row), index(row));
+        }
+    }
+}
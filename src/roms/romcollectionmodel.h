@@ -0,0 +1,161 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef ROMCOLLECTIONMODEL_H
+#define ROMCOLLECTIONMODEL_H
+
+#include "../common.h"
+#include "romfacetindex.h"
+#include "romfield.h"
+#include "romsearchindex.h"
+
+#include <QAbstractListModel>
+#include <QSet>
+#include <QVector>
+#include <QtSql/QSqlDatabase>
+
+class QSqlQuery;
+class RomCollection;
+
+
+// Model of the regular (non-64DD) ROMs in the collection database.
+//
+// There is one instance, owned by RomCollection, that all views observe.
+// Rows are read in keyset-paged chunks (ORDER BY an indexed column,
+// continuing after the last key seen) as views scroll towards the end,
+// and ROMs are only resolved (catalog, game info) when a view asks for
+// them; covers are left to CoverLoader.  Rows outside a window around the
+// viewport drop their resolved data again so memory stays bounded on
+// large collections.
+//
+// Loaded rows stay resident: changing the sort or switching layouts
+// reorders them in memory when the whole collection is loaded, and
+// single ROMs can be inserted, updated or removed without a reload.
+// A search filter and metadata facets hide rows without removing them;
+// views see only the matching rows through RomFilterModel.
+class RomCollectionModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        FileNameRole = Qt::UserRole,
+        DirectoryRole,
+        SearchRole,
+        MD5Role,
+        ZipFileRole
+    };
+
+    explicit RomCollectionModel(RomCollection *collection, QSqlDatabase database, QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+    QMap<QString, int> getFacetCounts(QString field) const;
+    QStringList getFacetFilter(QString field) const;
+    const Rom *getRom(int row) const;
+    static int getRoleFromName(QString infoName);
+    int getTotalCount() const;
+    bool isFiltered() const;
+    bool isRowVisible(int row) const;
+    void loadAll();
+    void releaseRows();
+    void reload(QString sort, bool descending);
+    void setSort(QString sort, bool descending);
+    void setViewport(int first, int last);
+
+    void insertRom(qint64 id);
+    void removeRom(QString md5);
+    void updateRom(QString md5);
+
+public slots:
+    void setFacetFilter(QString field, QStringList values);
+    void setFilter(QString text);
+
+signals:
+    void filterChanged();
+
+private:
+    struct Entry {
+        Rom rom;
+        qint64 id;
+        QString storedGoodName;
+        QVariant sortKey;
+        bool resolved;
+    };
+
+    //Normalized sort key of one entry, cheap to compare and to move
+    struct SortItem {
+        QString text;
+        qint64 number;
+        qint64 id;
+        int index;
+    };
+
+    void fetchAll();
+    void indexEntry(const Entry &entry) const;
+    SortItem getSortItem(const Entry &entry, int index) const;
+    QVariant getSortKey(const Entry &entry) const;
+    bool lessThan(const Entry &first, const Entry &last) const;
+    bool lessThan(const SortItem &first, const SortItem &last) const;
+    void readEntries(QSqlQuery &query, QVector<Entry> &result);
+    void releaseEntry(Entry &entry);
+    void resolveEntry(int row) const;
+    void setSortField(QString sort, bool descending);
+    void sortEntries(QVector<Entry> &list) const;
+    void sortRows();
+    void updateFilter();
+    void updateResolvedRows();
+
+    QString sort;
+    QString sortExpression;
+    RomFieldId sortField;
+    bool descending;
+    bool numericSort;
+    int totalCount;
+
+    mutable QVector<Entry> entries;
+    mutable QSet<int> resolvedRows;
+
+    QString filterText;
+    mutable QSet<qint64> filterMatches;
+    mutable RomSearchIndex searchIndex;
+
+    RomFacetIndex::Selection facetFilter;
+    mutable RomBitmap facetMatches;
+    mutable RomFacetIndex facetIndex;
+
+    RomCollection *collection;
+    QSqlDatabase database;
+};
+
+#endif // ROMCOLLECTIONMODEL_H
@@ -0,0 +1,171 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "romfacetindex.h"
+
+#include "../common.h"
+
+#include <QRegExp>
+
+
+void RomFacetIndex::clear()
+{
+    all = RomBitmap();
+    bitmaps.clear();
+    records.clear();
+}
+
+
+QMap<QString, int> RomFacetIndex::getCounts(const QString &field, const Selection &selection) const
+{
+    QMap<QString, int> counts;
+    RomBitmap base = select(selection, field);
+
+    const QMap<QString, RomBitmap> values = bitmaps.value(field);
+    for (QMap<QString, RomBitmap>::const_iterator value = values.constBegin(); value != values.constEnd(); ++value)
+        counts.insert(value.key(), (value.value() & base).cardinality());
+
+    return counts;
+}
+
+
+QStringList RomFacetIndex::getFields()
+{
+    return QStringList() << "Genre" << "Publisher" << "Developer" << "Release Year"
+                         << "Players" << "Save Type" << "Rumble" << "ESRB";
+}
+
+
+QStringList RomFacetIndex::getValues(const QString &field, const Rom &rom)
+{
+    QStringList values;
+
+    if (field == "Release Year") {
+        if (QRegExp("\\d{4}.*").exactMatch(rom.sortDate))
+            values << rom.sortDate.left(4);
+    } else if (field == "Genre") {
+        //A game can be in several genres
+        foreach (QString genre, rom.genre.split(","))
+            values << genre.trimmed();
+    } else
+        values << getRomInfo(field, &rom, true);
+
+    values.removeAll("");
+    values.removeDuplicates();
+
+    return values;
+}
+
+
+void RomFacetIndex::insert(quint32 id, const Rom &rom)
+{
+    Selection record;
+    foreach (QString field, getFields())
+    {
+        QStringList values = getValues(field, rom);
+        if (!values.isEmpty())
+            record.insert(field, values);
+    }
+
+    if (records.contains(id)) {
+        if (records.value(id) == record)
+            return;
+        remove(id);
+    }
+
+    all.add(id);
+    records.insert(id, record);
+
+    for (Selection::const_iterator field = record.constBegin(); field != record.constEnd(); ++field)
+        foreach (QString value, field.value())
+            bitmaps[field.key()][value].add(id);
+}
+
+
+bool RomFacetIndex::matches(quint32 id, const Selection &selection) const
+{
+    Selection record = records.value(id);
+
+    for (Selection::const_iterator field = selection.constBegin(); field != selection.constEnd(); ++field)
+    {
+        bool found = false;
+        foreach (QString value, field.value())
+            if (record.value(field.key()).contains(value))
+                found = true;
+
+        if (!found)
+            return false;
+    }
+
+    return true;
+}
+
+
+void RomFacetIndex::remove(quint32 id)
+{
+    if (!records.contains(id))
+        return;
+
+    Selection record = records.take(id);
+    all.remove(id);
+
+    for (Selection::const_iterator field = record.constBegin(); field != record.constEnd(); ++field)
+    {
+        QMap<QString, RomBitmap> &values = bitmaps[field.key()];
+
+        foreach (QString value, field.value())
+        {
+            values[value].remove(id);
+            if (values.value(value).isEmpty())
+                values.remove(value);
+        }
+    }
+}
+
+
+RomBitmap RomFacetIndex::select(const Selection &selection, const QString &skipField) const
+{
+    RomBitmap result = all;
+
+    for (Selection::const_iterator field = selection.constBegin(); field != selection.constEnd(); ++field)
+    {
+        if (field.key() == skipField)
+            continue;
+
+        RomBitmap any;
+        foreach (QString value, field.value())
+            any |= bitmaps.value(field.key()).value(value);
+
+        result &= any;
+    }
+
+    return result;
+}
@@ -0,0 +1,73 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef ROMFACETINDEX_H
+#define ROMFACETINDEX_H
+
+#include "rombitmap.h"
+
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+
+struct Rom;
+
+
+// Bitmap index over the scraped metadata of the collection.
+//
+// For every facet field (genre, publisher, release year, ...) each value
+// maps to the RomBitmap of ROM ids having it.  A selection ORs the values
+// picked within one field and ANDs the fields together.  Counts for a
+// field are taken against the selection of all other fields, so picking
+// a value doesn't hide its siblings.
+class RomFacetIndex
+{
+public:
+    typedef QMap<QString, QStringList> Selection;
+
+    static QStringList getFields();
+
+    void clear();
+    QMap<QString, int> getCounts(const QString &field, const Selection &selection) const;
+    void insert(quint32 id, const Rom &rom);
+    bool matches(quint32 id, const Selection &selection) const;
+    void remove(quint32 id);
+    RomBitmap select(const Selection &selection, const QString &skipField = "") const;
+
+private:
+    static QStringList getValues(const QString &field, const Rom &rom);
+
+    RomBitmap all;
+    QHash<QString, QMap<QString, RomBitmap> > bitmaps;
+    QHash<quint32, Selection> records;
+};
+
+#endif // ROMFACETINDEX_H
@@ -0,0 +1,170 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "romfield.h"
+
+#include <QHash>
+#include <QObject>
+
+
+// Listed in RomFieldId order so a field is looked up by indexing
+static constexpr RomField RomFields[] = {
+    { GoodNameField,          QT_TRANSLATE_NOOP("QObject", "GoodName"),             &Rom::goodName,     false, Qt::AlignLeft,    300, WarningSort },
+    { FilenameField,          QT_TRANSLATE_NOOP("QObject", "Filename"),             &Rom::baseName,     false, Qt::AlignLeft,    300, TextSort },
+    { FilenameExtensionField, QT_TRANSLATE_NOOP("QObject", "Filename (extension)"), &Rom::fileName,     false, Qt::AlignLeft,    300, TextSort },
+    { ZipFileField,           QT_TRANSLATE_NOOP("QObject", "Zip File"),             &Rom::zipFile,      false, Qt::AlignLeft,    100, TextSort },
+    { InternalNameField,      QT_TRANSLATE_NOOP("QObject", "Internal Name"),        &Rom::internalName, false, Qt::AlignLeft,    200, TextSort },
+    { SizeField,              QT_TRANSLATE_NOOP("QObject", "Size"),                 &Rom::size,         false, Qt::AlignRight,   75,  NumberSort },
+    { MD5Field,               QT_TRANSLATE_NOOP("QObject", "MD5"),                  &Rom::romMD5,       true,  Qt::AlignHCenter, 250, TextSort },
+    { CRC1Field,              QT_TRANSLATE_NOOP("QObject", "CRC1"),                 &Rom::CRC1,         true,  Qt::AlignHCenter, 90,  TextSort },
+    { CRC2Field,              QT_TRANSLATE_NOOP("QObject", "CRC2"),                 &Rom::CRC2,         true,  Qt::AlignHCenter, 90,  TextSort },
+    { PlayersField,           QT_TRANSLATE_NOOP("QObject", "Players"),              &Rom::players,      false, Qt::AlignRight,   75,  TextSort },
+    { RumbleField,            QT_TRANSLATE_NOOP("QObject", "Rumble"),               &Rom::rumble,       false, Qt::AlignHCenter, 75,  TextSort },
+    { SaveTypeField,          QT_TRANSLATE_NOOP("QObject", "Save Type"),            &Rom::saveType,     false, Qt::AlignRight,   100, TextSort },
+    { GameTitleField,         QT_TRANSLATE_NOOP("QObject", "Game Title"),           &Rom::gameTitle,    false, Qt::AlignLeft,    300, WarningSort },
+    { ReleaseDateField,       QT_TRANSLATE_NOOP("QObject", "Release Date"),         &Rom::releaseDate,  false, Qt::AlignRight,   100, DateSort },
+    { OverviewField,          QT_TRANSLATE_NOOP("QObject", "Overview"),             &Rom::overview,     false, Qt::AlignLeft,    400, TextSort },
+    { ESRBField,              QT_TRANSLATE_NOOP("QObject", "ESRB"),                 &Rom::esrb,         false, Qt::AlignHCenter, 150, TextSort },
+    { GenreField,             QT_TRANSLATE_NOOP("QObject", "Genre"),                &Rom::genre,        false, Qt::AlignHCenter, 150, TextSort },
+    { PublisherField,         QT_TRANSLATE_NOOP("QObject", "Publisher"),            &Rom::publisher,    false, Qt::AlignHCenter, 200, TextSort },
+    { DeveloperField,         QT_TRANSLATE_NOOP("QObject", "Developer"),            &Rom::developer,    false, Qt::AlignHCenter, 200, TextSort },
+    { RatingField,            QT_TRANSLATE_NOOP("QObject", "Rating"),               &Rom::rating,       false, Qt::AlignRight,   75,  TextSort },
+    { GameCoverField,         QT_TRANSLATE_NOOP("QObject", "Game Cover"),           NULL,               false, Qt::AlignLeft,    0,   NoSort }
+};
+
+static constexpr bool isInOrder(int index)
+{
+    return index == RomFieldCount || (RomFields[index].id == index && isInOrder(index + 1));
+}
+
+static_assert(sizeof(RomFields) / sizeof(RomFields[0]) == RomFieldCount, "Every RomFieldId needs a RomField");
+static_assert(isInOrder(0), "RomFields must be listed in RomFieldId order");
+
+
+static QHash<QString, RomFieldId> getNameMap()
+{
+    QHash<QString, RomFieldId> ids;
+    for (int i = 0; i < RomFieldCount; i++)
+        ids.insert(RomFields[i].name, RomFields[i].id);
+
+    return ids;
+}
+
+
+QString getCollationKey(const QString &text)
+{
+    //Decompose and drop the accents so Pokémon sorts with Pokemon
+    QString key;
+    foreach (QChar character, text.normalized(QString::NormalizationForm_KD))
+        if (!character.isMark())
+            key.append(character);
+
+    return key.toCaseFolded();
+}
+
+
+QString getLastCollationKey()
+{
+    //Above anything folded text contains, in UTF-16 and in SQLite's UTF-8 order
+    return QString(QChar(0xFFFF));
+}
+
+
+int getDefaultWidth(RomFieldId id, int imageWidth)
+{
+    if (id == InvalidField)
+        return 100;
+    else if (RomFields[id].defaultWidth == 0)
+        return imageWidth;
+
+    return RomFields[id].defaultWidth;
+}
+
+
+const RomField &getRomField(RomFieldId id)
+{
+    return RomFields[id];
+}
+
+
+RomFieldId getRomFieldId(const QString &name)
+{
+    static const QHash<QString, RomFieldId> ids = getNameMap();
+
+    return ids.value(name, InvalidField);
+}
+
+
+QVector<RomFieldId> getRomFieldIds(const QStringList &names)
+{
+    QVector<RomFieldId> ids;
+    ids.reserve(names.size());
+
+    //Unknown names are kept so column positions still line up with the setting
+    foreach (QString name, names)
+        ids << getRomFieldId(name);
+
+    return ids;
+}
+
+
+QString getRomFieldTitle(RomFieldId id)
+{
+    if (id == InvalidField)
+        return "";
+
+    return QObject::tr(RomFields[id].name);
+}
+
+
+QString getRomInfo(RomFieldId id, const Rom *rom, bool removeWarn, bool sort)
+{
+    if (id == InvalidField || RomFields[id].text == NULL)
+        return "";
+
+    const QString &text = rom->*RomFields[id].text;
+
+    if (removeWarn && isRomInfoWarning(text))
+        return sort ? "ZZZ" : ""; //Sort warnings at the end
+
+    return RomFields[id].lowerCase ? text.toLower() : text;
+}
+
+
+bool isRomInfoWarning(const QString &text)
+{
+    //Translated once, these are compared against every cell
+    static const QString unknown = getTranslation("Unknown ROM");
+    static const QString needsCatalog = getTranslation("Requires catalog file");
+    static const QString notFound = getTranslation("Not found");
+
+    return text == unknown || text == needsCatalog || text == notFound;
+}
@@ -0,0 +1,103 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef ROMFIELD_H
+#define ROMFIELD_H
+
+#include "../common.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+
+// Every piece of ROM information that can be shown as a column or label
+// or used as a sort order.  The settings store fields by name; views parse
+// those names once and work with these ids afterwards.
+enum RomFieldId {
+    InvalidField = -1,
+    GoodNameField,
+    FilenameField,
+    FilenameExtensionField,
+    ZipFileField,
+    InternalNameField,
+    SizeField,
+    MD5Field,
+    CRC1Field,
+    CRC2Field,
+    PlayersField,
+    RumbleField,
+    SaveTypeField,
+    GameTitleField,
+    ReleaseDateField,
+    OverviewField,
+    ESRBField,
+    GenreField,
+    PublisherField,
+    DeveloperField,
+    RatingField,
+    GameCoverField,
+    RomFieldCount
+};
+
+enum RomSortKind {
+    TextSort,      // Sort on the displayed text
+    WarningSort,   // Sort on the displayed text with warnings at the end
+    NumberSort,    // Sort on Rom::sortSize
+    DateSort,      // Sort on Rom::sortDate
+    NoSort         // Nothing to sort on
+};
+
+struct RomField {
+    RomFieldId id;
+    const char *name;           // Settings name, also the untranslated title
+    const QString Rom::*text;   // NULL if the field has no text
+    bool lowerCase;
+    Qt::AlignmentFlag alignment;
+    int defaultWidth;           // 0 means the width of the table image
+    RomSortKind sortKind;
+};
+
+// Text fields are sorted on a case folded key without accents, the same in
+// memory as in the key columns of the database, so paged and in-memory
+// orders agree.  Missing values sort after every key.
+QString getCollationKey(const QString &text);
+QString getLastCollationKey();
+
+int getDefaultWidth(RomFieldId id, int imageWidth);
+const RomField &getRomField(RomFieldId id);
+RomFieldId getRomFieldId(const QString &name);
+QVector<RomFieldId> getRomFieldIds(const QStringList &names);
+QString getRomFieldTitle(RomFieldId id);
+QString getRomInfo(RomFieldId id, const Rom *rom, bool removeWarn = false, bool sort = false);
+bool isRomInfoWarning(const QString &text);
+
+#endif // ROMFIELD_H
@@ -1,5 +1,5 @@
 /***
- * Copyright (c) 2013, Dan Hasting
+ * Copyright (c) 2019, Robert Alm Nilsson
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,27 +29,42 @@
  *
  ***/
 
-#include "treewidgetitem.h"
+#include "romfiltermodel.h"
+#include "romcollectionmodel.h"
 
 
-//Reimplemented QTreeWidgetItem operator to sort based on both integers and text
-bool TreeWidgetItem::operator< (const QTreeWidgetItem &other) const
+RomFilterModel::RomFilterModel(RomCollectionModel *model, QObject *parent)
+    : QSortFilterProxyModel(parent)
 {
-    int column = treeWidget()->sortColumn();
-
-    if (data(column, Qt::UserRole).toString() != "") {
-        if (data(column, Qt::UserRole).toString().contains(QRegExp("[^\\d]+"))) {
-            QString firstText = data(column, Qt::UserRole).toString();
-            QString otherText = other.data(column, Qt::UserRole).toString();
-            return firstText < otherText;
-        } else {
-            int firstNumber = data(column, Qt::UserRole).toInt();
-            int otherNumber = other.data(column, Qt::UserRole).toInt();
-            return firstNumber < otherNumber;
-        }
-    } else {
-        QString firstText = text(column);
-        QString otherText = other.text(column);
-        return firstText < otherText;
-    }
+    this->model = model;
+
+    setSourceModel(model);
+    setDynamicSortFilter(true);
+
+    connect(model, SIGNAL(filterChanged()), this, SLOT(invalidate()));
+}
+
+
+bool RomFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (sourceParent.isValid())
+        return false;
+
+    return model->isRowVisible(sourceRow);
+}
+
+
+const Rom *RomFilterModel::getRom(const QModelIndex &index) const
+{
+    QModelIndex sourceIndex = mapToSource(index);
+    if (!sourceIndex.isValid())
+        return NULL;
+
+    return model->getRom(sourceIndex.row());
+}
+
+
+RomCollectionModel *RomFilterModel::getSourceModel() const
+{
+    return model;
 }
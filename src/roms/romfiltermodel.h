@@ -1,5 +1,5 @@
 /***
- * Copyright (c) 2013, Dan Hasting
+ * Copyright (c) 2019, Robert Alm Nilsson
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,30 +29,32 @@
  *
  ***/
 
-#ifndef CLICKABLEWIDGET_H
-#define CLICKABLEWIDGET_H
+#ifndef ROMFILTERMODEL_H
+#define ROMFILTERMODEL_H
 
-#include <QWidget>
+#include <QSortFilterProxyModel>
 
-class QMouseEvent;
+class RomCollectionModel;
+struct Rom;
 
 
-class ClickableWidget : public QWidget
+// Proxy that leaves out the rows hidden by the search and the facets of
+// the collection model, so item views never lay out or paint them.
+// Rows keep the order of the collection model.
+class RomFilterModel : public QSortFilterProxyModel
 {
     Q_OBJECT
+
 public:
-    explicit ClickableWidget(QWidget *parent = 0);
+    explicit RomFilterModel(RomCollectionModel *model, QObject *parent = 0);
+    const Rom *getRom(const QModelIndex &index) const;
+    RomCollectionModel *getSourceModel() const;
 
 protected:
-    void keyPressEvent(QKeyEvent* event);
-    void mousePressEvent(QMouseEvent *event);
-    void mouseDoubleClickEvent(QMouseEvent *event);
-
-signals:
-    void arrowPressed(QWidget *current, QString keypress);
-    void enterPressed(QWidget *current);
-    void singleClicked(QWidget *current);
-    void doubleClicked(QWidget *current);
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
+
+private:
+    RomCollectionModel *model;
 };
 
-#endif // CLICKABLEWIDGET_H
+#endif // ROMFILTERMODEL_H
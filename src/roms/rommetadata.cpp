@@ -0,0 +1,219 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#include "rommetadata.h"
+
+#include "../common.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QRegExp>
+#include <QtSql/QSqlQuery>
+
+
+static const QString Columns = "md5, game_title, release_date, sort_date, overview, rating, players, "
+                               "genres, developer, publisher, boxart";
+
+
+RomMetadataStore::RomMetadataStore()
+{
+    loaded = false;
+}
+
+
+bool RomMetadataStore::contains(const QString &md5)
+{
+    load();
+    return games.contains(md5.toLower());
+}
+
+
+bool RomMetadataStore::find(const QString &md5, RomMetadata *metadata)
+{
+    load();
+
+    QHash<QString, RomMetadata>::const_iterator game = games.constFind(md5.toLower());
+    if (game == games.constEnd())
+        return false;
+
+    *metadata = *game;
+    return true;
+}
+
+
+RomMetadata RomMetadataStore::fromJson(const QJsonObject &gameData)
+{
+    //Remove any non-standard characters
+    QRegExp nonStandard("[^A-Za-z 0-9 \\.,\\?'""!@#\\$%\\^&\\*\\(\\)-_=\\+;:<>\\/\\\\|\\}\\{\\[\\]`~é]*");
+
+    RomMetadata metadata;
+    metadata.gameTitle = gameData.value("game_title").toString().remove(nonStandard);
+    metadata.sortDate = gameData.value("release_date").toString();
+    metadata.releaseDate = metadata.sortDate;
+    metadata.releaseDate.replace(QRegExp("(\\d{4})-(\\d{2})-(\\d{2})"), "\\2/\\3/\\1");
+    metadata.overview = gameData.value("overview").toString().remove(nonStandard);
+    metadata.rating = gameData.value("rating").toString();
+    metadata.players = gameData.value("players").toString();
+    metadata.genres = gameData.value("genres").toString();
+    metadata.developer = gameData.value("developer").toString();
+    metadata.publisher = gameData.value("publisher").toString();
+    metadata.boxart = gameData.value("boxart").toString();
+
+    return metadata;
+}
+
+
+void RomMetadataStore::importFiles()
+{
+    QDir cacheDir(getCacheLocation());
+
+    database.transaction();
+
+    foreach (QString md5, cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        //An empty file was a download that failed, leave it to be tried again
+        QFile file(cacheDir.absoluteFilePath(md5 + "/data.json"));
+        if (file.size() == 0 || !file.open(QIODevice::ReadOnly))
+            continue;
+
+        QJsonObject gameData = QJsonDocument::fromJson(file.readAll()).object();
+        file.close();
+
+        write(md5, fromJson(gameData));
+    }
+
+    database.commit();
+}
+
+
+void RomMetadataStore::insert(const QString &md5, const QJsonObject &gameData)
+{
+    write(md5, fromJson(gameData));
+}
+
+
+RomMetadataStore *RomMetadataStore::instance()
+{
+    static RomMetadataStore *store = new RomMetadataStore;
+    return store;
+}
+
+
+void RomMetadataStore::load()
+{
+    if (loaded)
+        return;
+
+    loaded = true;
+
+    if (!database.isOpen())
+        database.open();
+
+    QSqlQuery query("SELECT " + Columns + " FROM rom_metadata", database);
+
+    while (query.next())
+    {
+        RomMetadata metadata;
+        metadata.gameTitle = query.value(1).toString();
+        metadata.releaseDate = query.value(2).toString();
+        metadata.sortDate = query.value(3).toString();
+        metadata.overview = query.value(4).toString();
+        metadata.rating = query.value(5).toString();
+        metadata.players = query.value(6).toString();
+        metadata.genres = query.value(7).toString();
+        metadata.developer = query.value(8).toString();
+        metadata.publisher = query.value(9).toString();
+        metadata.boxart = query.value(10).toString();
+
+        games.insert(query.value(0).toString(), metadata);
+    }
+}
+
+
+void RomMetadataStore::release()
+{
+    games = QHash<QString, RomMetadata>();
+    loaded = false;
+}
+
+
+void RomMetadataStore::setup(QSqlDatabase database)
+{
+    this->database = database;
+
+    QSqlQuery table("SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'rom_metadata'", database);
+    bool created = !table.next();
+    table.finish();
+
+    database.exec(QString()
+                    + "CREATE TABLE IF NOT EXISTS rom_metadata ("
+                        + "md5 TEXT PRIMARY KEY, "
+                        + "game_title TEXT, "
+                        + "release_date TEXT, "
+                        + "sort_date TEXT, "
+                        + "overview TEXT, "
+                        + "rating TEXT, "
+                        + "players TEXT, "
+                        + "genres TEXT, "
+                        + "developer TEXT, "
+                        + "publisher TEXT, "
+                        + "boxart TEXT)");
+
+    //Game info used to be kept in a data.json file next to the cover
+    if (created)
+        importFiles();
+}
+
+
+void RomMetadataStore::write(const QString &md5, const RomMetadata &metadata)
+{
+    if (!database.isOpen())
+        database.open();
+
+    QSqlQuery query(database);
+    query.prepare("INSERT OR REPLACE INTO rom_metadata (" + Columns + ") "
+                  + "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(md5.toLower());
+    query.addBindValue(metadata.gameTitle);
+    query.addBindValue(metadata.releaseDate);
+    query.addBindValue(metadata.sortDate);
+    query.addBindValue(metadata.overview);
+    query.addBindValue(metadata.rating);
+    query.addBindValue(metadata.players);
+    query.addBindValue(metadata.genres);
+    query.addBindValue(metadata.developer);
+    query.addBindValue(metadata.publisher);
+    query.addBindValue(metadata.boxart);
+    query.exec();
+
+    if (loaded)
+        games.insert(md5.toLower(), metadata);
+}
@@ -0,0 +1,90 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#ifndef ROMMETADATA_H
+#define ROMMETADATA_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QtSql/QSqlDatabase>
+
+
+// Game info scraped for one ROM, cleaned up and ready to show
+struct RomMetadata {
+    QString gameTitle;
+    QString releaseDate;
+    QString sortDate;
+    QString overview;
+    QString rating;
+    QString players;
+    QString genres;
+    QString developer;
+    QString publisher;
+    QString boxart;
+};
+
+
+// Scraped game info by ROM md5, kept in the rom_metadata table of the
+// collection database.  It outlives rescans, which only replace
+// rom_collection.
+//
+// Text is cleaned up once when the scraper stores it.  The whole table is
+// read in one query the first time a ROM is looked up, and kept in memory
+// until release().  A row with no fields marks a game without info, so it
+// is not downloaded again unless the user asks.  The data.json files of
+// older versions are imported when the table is created.
+//
+// Only use from the GUI thread.
+class RomMetadataStore
+{
+public:
+    static RomMetadataStore *instance();
+
+    bool contains(const QString &md5);
+    bool find(const QString &md5, RomMetadata *metadata);
+    void insert(const QString &md5, const QJsonObject &gameData);
+    void release();
+    void setup(QSqlDatabase database);
+
+private:
+    RomMetadataStore();
+    void importFiles();
+    void load();
+    void write(const QString &md5, const RomMetadata &metadata);
+
+    static RomMetadata fromJson(const QJsonObject &gameData);
+
+    QSqlDatabase database;
+    QHash<QString, RomMetadata> games;
+    bool loaded;
+};
+
+#endif // ROMMETADATA_H
@@ -0,0 +1,169 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "romsearchindex.h"
+
+#include <QPair>
+#include <QRegExp>
+
+#include <algorithm>
+
+
+void RomSearchIndex::clear()
+{
+    documents.clear();
+    postings.clear();
+}
+
+
+QSet<RomSearchIndex::Trigram> RomSearchIndex::getTrigrams(const QString &text)
+{
+    QSet<Trigram> trigrams;
+
+    for (int i = 0; i + 3 <= text.size(); i++)
+    {
+        //Fields are separated by newlines, so no trigram spans two of them
+        if (text.at(i) == '\n' || text.at(i + 1) == '\n' || text.at(i + 2) == '\n')
+            continue;
+
+        trigrams.insert((Trigram(text.at(i).unicode()) << 32) |
+                        (Trigram(text.at(i + 1).unicode()) << 16) |
+                         Trigram(text.at(i + 2).unicode()));
+    }
+
+    return trigrams;
+}
+
+
+QStringList RomSearchIndex::getWords(const QString &text)
+{
+    return text.toCaseFolded().split(QRegExp("\\s+"), QString::SkipEmptyParts);
+}
+
+
+void RomSearchIndex::insert(qint64 id, const QStringList &fields)
+{
+    QString document = fields.join("\n").toCaseFolded();
+
+    if (documents.contains(id)) {
+        if (documents.value(id) == document)
+            return;
+        remove(id);
+    }
+
+    documents.insert(id, document);
+
+    foreach (Trigram trigram, getTrigrams(document))
+        postings[trigram].add(quint32(id));
+}
+
+
+bool RomSearchIndex::matches(qint64 id, const QString &text) const
+{
+    return matchesWords(documents.value(id), getWords(text));
+}
+
+
+bool RomSearchIndex::matchesWords(const QString &document, const QStringList &words) const
+{
+    foreach (QString word, words)
+        if (!document.contains(word))
+            return false;
+
+    return true;
+}
+
+
+void RomSearchIndex::remove(qint64 id)
+{
+    if (!documents.contains(id))
+        return;
+
+    foreach (Trigram trigram, getTrigrams(documents.take(id)))
+    {
+        RomBitmap &ids = postings[trigram];
+        ids.remove(quint32(id));
+
+        if (ids.isEmpty())
+            postings.remove(trigram);
+    }
+}
+
+
+QSet<qint64> RomSearchIndex::search(const QString &text) const
+{
+    QStringList words = getWords(text);
+    QSet<qint64> result;
+
+    if (words.isEmpty())
+        return result;
+
+    QSet<Trigram> trigrams;
+    foreach (QString word, words)
+        trigrams += getTrigrams(word);
+
+    QList<qint64> candidates;
+
+    if (trigrams.isEmpty()) {
+        //Only words shorter than a trigram, so every ROM is a candidate
+        candidates = documents.keys();
+    } else {
+        QList<QPair<int, const RomBitmap*> > lists;
+        foreach (Trigram trigram, trigrams)
+        {
+            QHash<Trigram, RomBitmap>::const_iterator ids = postings.constFind(trigram);
+            if (ids == postings.constEnd())
+                return result;
+            lists.append(qMakePair(ids->cardinality(), &ids.value()));
+        }
+
+        //Intersect starting from the rarest trigram so the candidate set shrinks fastest
+        std::sort(lists.begin(), lists.end(),
+                  [](const QPair<int, const RomBitmap*> &first, const QPair<int, const RomBitmap*> &last) {
+            return first.first < last.first;
+        });
+
+        RomBitmap matches = *lists.first().second;
+        for (int i = 1; i < lists.size() && !matches.isEmpty(); i++)
+            matches &= *lists.at(i).second;
+
+        foreach (quint32 id, matches.toList())
+            candidates.append(id);
+    }
+
+    //Trigrams can match out of order, so confirm each candidate
+    result.reserve(candidates.size());
+    foreach (qint64 id, candidates)
+        if (matchesWords(documents.value(id), words))
+            result.insert(id);
+
+    return result;
+}
@@ -0,0 +1,71 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef ROMSEARCHINDEX_H
+#define ROMSEARCHINDEX_H
+
+#include "rombitmap.h"
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+
+// Trigram index over the searchable text of each ROM in the collection.
+//
+// Every document (the folded GoodName, filenames, internal name and game
+// title of one ROM) is split into overlapping three-character keys, and
+// each key maps to a bitmap of the ROM ids containing it, the same
+// compressed sets the facets use, so ids can come in any order.  A query
+// word intersects the bitmaps of its trigrams and confirms the candidates
+// with a substring match, so a search only touches ROMs that can match.
+class RomSearchIndex
+{
+public:
+    void clear();
+    void insert(qint64 id, const QStringList &fields);
+    bool matches(qint64 id, const QString &text) const;
+    void remove(qint64 id);
+    QSet<qint64> search(const QString &text) const;
+
+private:
+    typedef quint64 Trigram;
+
+    static QSet<Trigram> getTrigrams(const QString &text);
+    static QStringList getWords(const QString &text);
+    bool matchesWords(const QString &document, const QStringList &words) const;
+
+    QHash<qint64, QString> documents;
+    QHash<Trigram, RomBitmap> postings;
+};
+
+#endif // ROMSEARCHINDEX_H
@@ -0,0 +1,242 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "romtablemodel.h"
+#include "romcollectionmodel.h"
+#include "romfiltermodel.h"
+
+#include <QBrush>
+
+
+RomTableModel::RomTableModel(RomFilterModel *model, QObject *parent)
+    : QAbstractTableModel(parent)
+{
+    this->model = model;
+
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)),
+            this, SLOT(sourceDataChanged(QModelIndex, QModelIndex)));
+    connect(model, SIGNAL(layoutAboutToBeChanged()), this, SLOT(sourceLayoutAboutToBeChanged()));
+    connect(model, SIGNAL(layoutChanged()), this, SLOT(sourceLayoutChanged()));
+    connect(model, SIGNAL(modelAboutToBeReset()), this, SLOT(sourceModelAboutToBeReset()));
+    connect(model, SIGNAL(modelReset()), this, SLOT(sourceModelReset()));
+    connect(model, SIGNAL(rowsAboutToBeInserted(QModelIndex, int, int)),
+            this, SLOT(sourceRowsAboutToBeInserted(QModelIndex, int, int)));
+    connect(model, SIGNAL(rowsAboutToBeRemoved(QModelIndex, int, int)),
+            this, SLOT(sourceRowsAboutToBeRemoved(QModelIndex, int, int)));
+    connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(sourceRowsInserted()));
+    connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(sourceRowsRemoved()));
+}
+
+
+bool RomTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return false;
+
+    return model->canFetchMore(QModelIndex());
+}
+
+
+int RomTableModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return columns.size();
+}
+
+
+QVariant RomTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.column() >= columns.size())
+        return QVariant();
+
+    //ROM roles are the same for the whole row
+    if (role >= Qt::UserRole)
+        return model->index(index.row(), 0).data(role);
+
+    RomFieldId field = columns.at(index.column());
+    if (field == InvalidField)
+        return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return getRomInfo(field, getRom(index));
+    case Qt::TextAlignmentRole:
+        return int(getRomField(field).alignment | Qt::AlignVCenter);
+    case Qt::ForegroundRole:
+        if (getRomField(field).sortKind == WarningSort && isRomInfoWarning(getRomInfo(field, getRom(index))))
+            return QBrush(Qt::gray);
+        break;
+    }
+
+    return QVariant();
+}
+
+
+void RomTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (!parent.isValid())
+        model->fetchMore(QModelIndex());
+}
+
+
+RomFieldId RomTableModel::getColumnField(int column) const
+{
+    return columns.value(column, InvalidField);
+}
+
+
+const QVector<RomFieldId> &RomTableModel::getColumns() const
+{
+    return columns;
+}
+
+
+const Rom *RomTableModel::getRom(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return NULL;
+
+    return model->getRom(model->index(index.row(), 0));
+}
+
+
+QVariant RomTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    //Remove Game Cover title for aesthetics
+    RomFieldId field = getColumnField(section);
+    if (field == GameCoverField)
+        return QString("");
+
+    return getRomFieldTitle(field);
+}
+
+
+int RomTableModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return model->rowCount();
+}
+
+
+void RomTableModel::setColumns(const QVector<RomFieldId> &columns)
+{
+    if (columns == this->columns)
+        return;
+
+    beginResetModel();
+    this->columns = columns;
+    endResetModel();
+}
+
+
+void RomTableModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (columns.isEmpty())
+        return;
+
+    emit dataChanged(index(topLeft.row(), 0), index(bottomRight.row(), columns.size() - 1));
+}
+
+
+void RomTableModel::sourceLayoutAboutToBeChanged()
+{
+    emit layoutAboutToBeChanged();
+
+    //Remember which filter row each persistent cell is on so it can follow the row
+    layoutIndexes = persistentIndexList();
+    layoutSourceIndexes.clear();
+    foreach (QModelIndex index, layoutIndexes)
+        layoutSourceIndexes << QPersistentModelIndex(model->index(index.row(), 0));
+}
+
+
+void RomTableModel::sourceLayoutChanged()
+{
+    for (int i = 0; i < layoutIndexes.size(); i++)
+    {
+        const QPersistentModelIndex &sourceIndex = layoutSourceIndexes.at(i);
+
+        if (sourceIndex.isValid())
+            changePersistentIndex(layoutIndexes.at(i), index(sourceIndex.row(), layoutIndexes.at(i).column()));
+        else
+            changePersistentIndex(layoutIndexes.at(i), QModelIndex());
+    }
+
+    layoutIndexes.clear();
+    layoutSourceIndexes.clear();
+
+    emit layoutChanged();
+}
+
+
+void RomTableModel::sourceModelAboutToBeReset()
+{
+    beginResetModel();
+}
+
+
+void RomTableModel::sourceModelReset()
+{
+    endResetModel();
+}
+
+
+void RomTableModel::sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid())
+        beginInsertRows(QModelIndex(), first, last);
+}
+
+
+void RomTableModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid())
+        beginRemoveRows(QModelIndex(), first, last);
+}
+
+
+void RomTableModel::sourceRowsInserted()
+{
+    endInsertRows();
+}
+
+
+void RomTableModel::sourceRowsRemoved()
+{
+    endRemoveRows();
+}
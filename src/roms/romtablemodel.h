@@ -0,0 +1,86 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef ROMTABLEMODEL_H
+#define ROMTABLEMODEL_H
+
+#include "romfield.h"
+
+#include <QAbstractTableModel>
+#include <QPersistentModelIndex>
+#include <QVector>
+
+class RomFilterModel;
+
+
+// Table of the visible ROMs with one column per field chosen in the
+// table settings.  Rows follow the filter model, which already has the
+// sort order of the collection, so the table doesn't sort on its own.
+// Cells are only read when a view paints them.
+class RomTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit RomTableModel(RomFilterModel *model, QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+    RomFieldId getColumnField(int column) const;
+    const QVector<RomFieldId> &getColumns() const;
+    const Rom *getRom(const QModelIndex &index) const;
+    void setColumns(const QVector<RomFieldId> &columns);
+
+private:
+    RomFilterModel *model;
+    QVector<RomFieldId> columns;
+
+    QModelIndexList layoutIndexes;
+    QList<QPersistentModelIndex> layoutSourceIndexes;
+
+private slots:
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void sourceLayoutAboutToBeChanged();
+    void sourceLayoutChanged();
+    void sourceModelAboutToBeReset();
+    void sourceModelReset();
+    void sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsInserted();
+    void sourceRowsRemoved();
+};
+
+#endif // ROMTABLEMODEL_H
@@ -33,67 +33,109 @@
 
 #include "../global.h"
 #include "../common.h"
+#include "../error.h"
+#include "../stallwatchdog.h"
+#include "rommetadata.h"
+#include "titlematcher.h"
 
 #include <QDir>
 #include <QEventLoop>
 #include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
 #include <QMessageBox>
+#include <QSet>
 #include <QTextStream>
 #include <QTimer>
-#include <QUrl>
 
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
 
 
+// Platform ID of the Nintendo 64 on TheGamesDB
+static const int N64Platform = 3;
+
+// Requests a scan keeps open at once, the per host limit of the network manager
+static const int MaxConnections = 6;
+
+// Failed requests after which a scan gives up on the rest
+static const int MaxErrors = 10;
+
+// Lists that turn the IDs in game info into names
+static const char *ListNames[] = { "Genres", "Developers", "Publishers" };
+static const int ListCount = sizeof(ListNames) / sizeof(ListNames[0]);
+
+// Names by ID of each list, read from the cache once and shared by all
+// scrapers, and the lists already downloaded again this session
+static QHash<QString, QHash<int, QString> > idLists;
+static QSet<QString> refreshedLists;
+
+
 TheGamesDBScraper::TheGamesDBScraper(QWidget *parent, bool force) : QObject(parent)
 {
     this->parent = parent;
     this->force = force;
     this->keepGoing = true;
+    this->offline = false;
+
+    listsPending = 0;
+    queueClosed = false;
+    paused = false;
+    gamesDownloaded = 0;
+    coversDownloaded = 0;
 }
 
 
-QString TheGamesDBScraper::convertIDs(QJsonObject foundGame, QString typeName, QString listName)
+void TheGamesDBScraper::cancelJobs()
 {
-    QJsonArray idArray = foundGame.value(typeName).toArray();
+    keepGoing = false;
 
-    QString cacheFileString = getCacheLocation() + typeName + ".json";
-    QFile cacheFile(cacheFileString);
+    foreach (QString key, queue) {
+        if (jobs.take(key).type == ListJob)
+            listsPending--;
+    }
+    queue.clear();
+
+    for (int i = 0; i < parkedGames.size(); i++)
+        jobs.remove(parkedGames.at(i).first);
+    parkedGames.clear();
+
+    //Their replies come back as errors and are dropped
+    foreach (QNetworkReply *reply, replies.keys())
+        reply->abort();
+}
 
-    cacheFile.open(QIODevice::ReadOnly);
-    QString data = cacheFile.readAll();
-    cacheFile.close();
 
-    QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
-    QJsonObject cache = document.object();
+void TheGamesDBScraper::closeQueue()
+{
+    queueClosed = true;
+
+    if (jobs.isEmpty()) {
+        reportErrors();
+        emit finished();
+    }
+}
+
 
-    QString result = "";
+QString TheGamesDBScraper::convertIDs(QJsonObject foundGame, QString typeName, QString listName)
+{
+    QStringList names;
 
-    foreach (QJsonValue id, idArray)
+    foreach (QJsonValue id, foundGame.value(typeName).toArray())
     {
-        QString entryID = QString::number(id.toInt());
-        QString entryName = cache.value(entryID).toObject().value("name").toString();
+        QString entryName = getIDList(typeName).value(id.toInt());
 
-        if (entryName == "") {
+        //An unknown ID means the cached list is older than the game
+        if (entryName == "" && !offline && !refreshedLists.contains(typeName)) {
+            QFile cacheFile(getCacheLocation() + typeName + ".json");
             updateListCache(&cacheFile, listName);
-            cacheFile.open(QIODevice::ReadOnly);
-            data = cacheFile.readAll();
-            cacheFile.close();
-
-            document = QJsonDocument::fromJson(data.toUtf8());
-            entryName = cache.value(entryID).toObject().value("name").toString();
+            entryName = getIDList(typeName).value(id.toInt());
         }
 
         if (entryName != "")
-            result += entryName + ", ";
+            names << entryName;
     }
 
-    int pos = result.lastIndexOf(QChar(','));
-    return result.left(pos);
+    return names.join(", ");
 }
 
 
@@ -117,14 +159,8 @@ void TheGamesDBScraper::deleteGameInfo(QString fileName, QString identifier)
     if (answer == QMessageBox::Yes) {
         QString gameCache = getCacheLocation() + identifier.toLower();
 
-        QString dataFile = gameCache + "/data.xml";
-        QFile file(dataFile);
-
-        // Remove game information
-        file.open(QIODevice::WriteOnly);
-        QTextStream stream(&file);
-        stream << "NULL";
-        file.close();
+        // Remove game information, an empty entry keeps it from being downloaded again
+        RomMetadataStore::instance()->insert(identifier, QJsonObject());
 
         // Remove cover image
         QString coverFile = gameCache + "/boxart-front.";
@@ -147,6 +183,8 @@ void TheGamesDBScraper::deleteGameInfo(QString fileName, QString identifier)
 
 void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName, QString gameID)
 {
+    StallOperation operation("Downloading game info");
+
     if (keepGoing && identifier != "") {
         if (force) parent->setEnabled(false);
 
@@ -172,47 +210,12 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
             updateListCache(&publishers, "Publishers");
 
         //Get game JSON info from thegamesdb.net
-        QString dataFile = gameCache + "/data.json";
-        QFile file(dataFile);
-
-        if (!file.exists() || file.size() == 0 || force) {
-            QUrl url;
-
-            //Remove [!], (U), etc. from GoodName for searching
-            searchName.remove(QRegExp("\\W*(\\(|\\[).+(\\)|\\])\\W*"));
-
-            //Few game specific hacks
-            if (searchName == "Legend of Zelda, The - Majora's Mask" ||
-                searchName == "ZELDA MAJORA'S MASK")
-                searchName = "Majora's Mask";
-            else if (searchName == "Legend of Zelda, The - Ocarina of Time" ||
-                     searchName == "THE LEGEND OF ZELDA")
-                searchName = "The Legend of Zelda: Ocarina of Time";
-            else if (searchName.toLower().startsWith("tsumi to batsu"))
-                searchName = "Sin and Punishment";
-            else if (searchName.toLower() == "1080 snowboarding")
-                searchName = "1080: TenEighty Snowboarding";
-            else if (searchName == "Extreme-G XG2" || searchName == "Extreme G 2")
-                searchName = "Extreme-G 2";
-            else if (searchName.contains("Pokemon", Qt::CaseInsensitive))
-                searchName.replace("Pokemon", "Pokémon", Qt::CaseInsensitive);
-            else if (searchName.toLower() == "smash brothers")
-                searchName = "Super Smash Bros.";
-            else if (searchName.toLower() == "conker bfd")
-                searchName = "Conker's Bad Fur Day";
-
-            QString apiFilter = "&filter[platform]=3&include=boxart&fields=game_title,release_date,";
-            apiFilter += "developers,publishers,genres,overview,rating,players";
-
-            //If user submits gameID, use that
-            if (gameID != "")
-                url.setUrl("https://api.thegamesdb.net/Games/ByGameID?apikey=" + TheGamesDBAPIKey + "&id="
-                           + gameID + apiFilter);
-            else
-                url.setUrl("https://api.thegamesdb.net/Games/ByGameName?apikey=" + TheGamesDBAPIKey + "&name="
-                           + searchName + apiFilter);
-
-            QString data = getUrlContents(url);
+        RomMetadataStore *store = RomMetadataStore::instance();
+
+        if (!store->contains(identifier) || force) {
+            searchName = getSearchName(searchName);
+
+            QString data = getUrlContents(getGameUrl(searchName, gameID));
 
             QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
             QJsonObject json = document.object();
@@ -233,11 +236,10 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
 
             int count = 0, found = 0;
 
-            foreach (QJsonValue game, gamesArray)
-            {
-                QJsonValue title = game.toObject().value("game_title");
-
-                if (force) { //from user dialog
+            if (force) { //from user dialog
+                foreach (QJsonValue game, gamesArray)
+                {
+                    QJsonValue title = game.toObject().value("game_title");
                     QJsonValue date = game.toObject().value("release_date");
 
                     QString check = "Game: " + title.toString();
@@ -254,63 +256,17 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
                         updated = true;
                         break;
                     }
-                } else {
-                    //We only want one game, so search for a perfect match in the GameTitle element.
-                    //Otherwise this will default to 0 (the first game found)
-                    if(title.toString().toLower() == searchName.toLower())
-                        found = count;
-                }
-
-                count++;
-            }
-
-            if (!force || updated) {
-                QJsonObject foundGame = gamesArray.at(found).toObject();
-                QJsonObject saveData;
-
-                QString gameID = QString::number(foundGame.value("id").toInt());
-                QJsonObject boxart = json.value("include").toObject().value("boxart").toObject();
 
-                QString thumbURL = boxart.value("base_url").toObject().value("thumb").toString();
-                QJsonArray imgArray = boxart.value("data").toObject().value(gameID).toArray();
-
-                QString frontImg = "";
-
-                foreach (QJsonValue img, imgArray)
-                {
-                    QString type = img.toObject().value("type").toString();
-                    QString side = img.toObject().value("side").toString();
-                    QString filename = img.toObject().value("filename").toString();
-
-                    if (type == "boxart" && side == "front")
-                        frontImg = thumbURL + filename;
+                    count++;
                 }
-
-                //Convert IDs from API to text names
-                QString genresString = convertIDs(foundGame, "genres", "Genres");
-                QString developerString = convertIDs(foundGame, "developers", "Developers");
-                QString publisherString = convertIDs(foundGame, "publishers", "Publishers");
-
-                QString players = QString::number(foundGame.value("players").toInt());
-                if (players == "0") players = "";
-
-                saveData.insert("game_title", foundGame.value("game_title").toString());
-                saveData.insert("release_date", foundGame.value("release_date").toString());
-                saveData.insert("rating", foundGame.value("rating").toString());
-                saveData.insert("overview", foundGame.value("overview").toString());
-                saveData.insert("players", players);
-                saveData.insert("boxart", frontImg);
-                saveData.insert("genres", genresString);
-                saveData.insert("developer", developerString);
-                saveData.insert("publisher", publisherString);
-
-                QJsonDocument document(saveData);
-
-                file.open(QIODevice::WriteOnly);
-                file.write(document.toJson());
-                file.close();
+            } else {
+                found = findGame(gamesArray, searchName);
             }
 
+            //Without a match nothing is stored, so the next scan searches again
+            if ((!force && found >= 0) || updated)
+                store->insert(identifier, getGameData(json, found));
+
             if (force && !updated) {
                 QString message;
 
@@ -333,13 +289,9 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
         QFile coverPNG(coverFile + "png");
 
         if ((!coverJPG.exists() && !coverPNG.exists()) || (force && updated)) {
-            file.open(QIODevice::ReadOnly);
-            QString data = file.readAll();
-            file.close();
-
-            QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
-            QJsonObject json = document.object();
-            QString boxartURL = json.value("boxart").toString();
+            RomMetadata metadata;
+            store->find(identifier, &metadata);
+            QString boxartURL = metadata.boxart;
 
             if (boxartURL != "") {
                 QUrl url(boxartURL);
@@ -370,45 +322,549 @@ void TheGamesDBScraper::downloadGameInfo(QString identifier, QString searchName,
 }
 
 
-QByteArray TheGamesDBScraper::getUrlContents(QUrl url)
+int TheGamesDBScraper::findGame(QJsonArray gamesArray, QString searchName)
+{
+    //We only want one game, the result with the closest title.  Between equally close
+    //ones the API's order wins.  With none close enough this is -1.
+    TitleMatcher matcher;
+
+    for (int i = 0; i < gamesArray.size(); i++)
+        matcher.insert(i, gamesArray.at(i).toObject().value("game_title").toString());
+
+    return matcher.match(searchName);
+}
+
+
+void TheGamesDBScraper::finishCover(const Job &job, const QByteArray &data)
+{
+    QString boxartExt = QFileInfo(job.name).completeSuffix().toLower();
+
+    foreach (QString identifier, job.identifiers)
+    {
+        QString coverFile = getCacheLocation() + identifier.toLower() + "/boxart-front.";
+
+        QFile::remove(coverFile + "jpg");
+        QFile::remove(coverFile + "png");
+
+        QFile cover(coverFile + boxartExt);
+        cover.open(QIODevice::WriteOnly);
+        cover.write(data);
+        cover.close();
+
+        emit gameInfoUpdated(identifier);
+    }
+
+    coversDownloaded++;
+}
+
+
+void TheGamesDBScraper::finishGame(const Job &job, const QJsonObject &json)
+{
+    if (json.value("code").toInt() != 200 && json.value("code").toInt() != 0) {
+        reportError(tr("TheGamesDB: ") + json.value("status").toString());
+        return;
+    }
+
+    QJsonArray gamesArray = json.value("data").toObject().value("games").toArray();
+    int found = findGame(gamesArray, job.name);
+
+    //Without a match nothing is stored, so the next scan searches again
+    if (found < 0)
+        return;
+
+    QJsonObject gameData = getGameData(json, found);
+
+    foreach (QString identifier, job.identifiers)
+    {
+        RomMetadataStore::instance()->insert(identifier, gameData);
+        emit gameInfoUpdated(identifier);
+    }
+
+    gamesDownloaded++;
+
+    //Start on the cover while the other searches are still out
+    QString boxartURL = gameData.value("boxart").toString();
+    if (boxartURL == "")
+        return;
+
+    foreach (QString identifier, job.identifiers)
+    {
+        QString coverFile = getCacheLocation() + identifier.toLower() + "/boxart-front.";
+        if (!QFile::exists(coverFile + "jpg") && !QFile::exists(coverFile + "png"))
+            queueJob(CoverJob, QUrl(boxartURL), boxartURL, identifier);
+    }
+}
+
+
+void TheGamesDBScraper::finishReply()
+{
+    StallOperation operation("Saving game info");
+
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    QString key = replies.take(reply);
+    reply->deleteLater();
+
+    Job job = jobs.value(key);
+
+    if (reply->error() != QNetworkReply::NoError) {
+        if (reply->error() == QNetworkReply::OperationCanceledError)
+            reportError(tr("Request timed out. Check your network settings."));
+        else
+            reportError(reply->errorString());
+
+        jobs.remove(key);
+        if (job.type == ListJob) {
+            refreshedLists.insert(job.name.toLower());
+            listsPending--;
+        }
+    } else if (job.type == ListJob) {
+        QFile file(getCacheLocation() + job.name.toLower() + ".json");
+        saveListCache(&file, job.name, reply->readAll());
+
+        jobs.remove(key);
+        listsPending--;
+    } else if (job.type == GameJob) {
+        //Names are looked up in the lists, so games wait for any being downloaded
+        parkedGames.append(qMakePair(key, QJsonDocument::fromJson(reply->readAll()).object()));
+    } else {
+        jobs.remove(key);
+        finishCover(job, reply->readAll());
+    }
+
+    while (listsPending == 0 && !parkedGames.isEmpty()) {
+        QPair<QString, QJsonObject> parked = parkedGames.first();
+
+        if (queueListUpdates(jobs.value(parked.first), parked.second))
+            break;
+
+        parkedGames.removeFirst();
+        finishGame(jobs.take(parked.first), parked.second);
+    }
+
+    startJobs();
+
+    if (jobs.isEmpty()) {
+        if (gamesDownloaded > 0 || coversDownloaded > 0)
+            LOG_I(QString("Downloaded game info for %1 games and %2 covers in %3 s")
+                  .arg(gamesDownloaded).arg(coversDownloaded).arg(batchTimer.elapsed() / 1000.0));
+
+        gamesDownloaded = 0;
+        coversDownloaded = 0;
+
+        if (queueClosed) {
+            reportErrors();
+            emit finished();
+        }
+    }
+}
+
+
+QString TheGamesDBScraper::getApiUrl()
 {
-    QNetworkAccessManager *manager = new QNetworkAccessManager;
+    QString url = SETTINGS.value("Other/gamesdburl", "https://api.thegamesdb.net/").toString();
+    if (!url.endsWith("/"))
+        url += "/";
+
+    return url;
+}
+
+
+QJsonObject TheGamesDBScraper::getGameData(QJsonObject json, int found)
+{
+    QJsonArray gamesArray = json.value("data").toObject().value("games").toArray();
+    QJsonObject saveData;
+
+    if (found < 0 || found >= gamesArray.size())
+        return saveData;
+
+    QJsonObject foundGame = gamesArray.at(found).toObject();
+
+    QString gameID = QString::number(foundGame.value("id").toInt());
+    QJsonObject boxart = json.value("include").toObject().value("boxart").toObject();
+
+    QString thumbURL = boxart.value("base_url").toObject().value("thumb").toString();
+    QJsonArray imgArray = boxart.value("data").toObject().value(gameID).toArray();
+
+    QString frontImg = "";
+
+    foreach (QJsonValue img, imgArray)
+    {
+        QString type = img.toObject().value("type").toString();
+        QString side = img.toObject().value("side").toString();
+        QString filename = img.toObject().value("filename").toString();
+
+        if (type == "boxart" && side == "front")
+            frontImg = thumbURL + filename;
+    }
+
+    //Convert IDs from API to text names
+    QString genresString = convertIDs(foundGame, "genres", "Genres");
+    QString developerString = convertIDs(foundGame, "developers", "Developers");
+    QString publisherString = convertIDs(foundGame, "publishers", "Publishers");
+
+    QString players = QString::number(foundGame.value("players").toInt());
+    if (players == "0") players = "";
+
+    saveData.insert("game_title", foundGame.value("game_title").toString());
+    saveData.insert("release_date", foundGame.value("release_date").toString());
+    saveData.insert("rating", foundGame.value("rating").toString());
+    saveData.insert("overview", foundGame.value("overview").toString());
+    saveData.insert("players", players);
+    saveData.insert("boxart", frontImg);
+    saveData.insert("genres", genresString);
+    saveData.insert("developer", developerString);
+    saveData.insert("publisher", publisherString);
+
+    return saveData;
+}
+
+
+QUrl TheGamesDBScraper::getGameUrl(QString searchName, QString gameID)
+{
+    QString apiFilter = "&filter[platform]=" + QString::number(N64Platform);
+    apiFilter += "&include=boxart&fields=game_title,release_date,";
+    apiFilter += "developers,publishers,genres,overview,rating,players";
+
+    //If user submits gameID, use that
+    if (gameID != "")
+        return QUrl(getApiUrl() + "Games/ByGameID?apikey=" + TheGamesDBAPIKey + "&id=" + gameID + apiFilter);
+
+    return QUrl(getApiUrl() + "Games/ByGameName?apikey=" + TheGamesDBAPIKey + "&name=" + searchName + apiFilter);
+}
+
+
+const QHash<int, QString> &TheGamesDBScraper::getIDList(QString typeName)
+{
+    QHash<QString, QHash<int, QString> >::iterator list = idLists.find(typeName);
+
+    if (list == idLists.end()) {
+        QFile cacheFile(getCacheLocation() + typeName + ".json");
+        cacheFile.open(QIODevice::ReadOnly);
+        QJsonObject cache = QJsonDocument::fromJson(cacheFile.readAll()).object();
+        cacheFile.close();
+
+        QHash<int, QString> names;
+        for (QJsonObject::const_iterator entry = cache.constBegin(); entry != cache.constEnd(); ++entry)
+            names.insert(entry.key().toInt(), entry.value().toObject().value("name").toString());
+
+        list = idLists.insert(typeName, names);
+    }
+
+    return *list;
+}
 
+
+QUrl TheGamesDBScraper::getListUrl(QString list)
+{
+    return QUrl(getApiUrl() + list + "?apikey=" + TheGamesDBAPIKey);
+}
+
+
+QNetworkAccessManager *TheGamesDBScraper::getNetworkManager()
+{
+    //Shared so connections to the API are kept alive between requests
+    static QNetworkAccessManager *manager = new QNetworkAccessManager;
+    return manager;
+}
+
+
+QNetworkRequest TheGamesDBScraper::getRequest(QUrl url)
+{
     QNetworkRequest request;
     request.setUrl(url);
     request.setRawHeader("User-Agent", AppName.toUtf8().constData());
-    QNetworkReply *reply = manager->get(request);
+#if QT_VERSION >= 0x050800
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
 
-    QTimer timer;
-    timer.setSingleShot(true);
+    return request;
+}
 
-    QEventLoop loop;
-    connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
-    connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
 
+QString TheGamesDBScraper::getSearchName(QString searchName)
+{
+    //Remove [!], (U), etc. from GoodName for searching
+    searchName.remove(QRegExp("\\W*(\\(|\\[).+(\\)|\\])\\W*"));
+
+    //Some games are only found under the name TheGamesDB has for them
+    return TitleMatcher::getAlias(searchName);
+}
+
+
+int TheGamesDBScraper::getTimeout()
+{
     int time = SETTINGS.value("Other/networktimeout", 10).toInt();
     if (time == 0) {
         time = 10;
     }
-    time *= 1000;
 
-    timer.start(time);
+    return time * 1000;
+}
+
+
+QByteArray TheGamesDBScraper::getUrlContents(QUrl url)
+{
+    QNetworkReply *reply = getNetworkManager()->get(getRequest(url));
+
+    QTimer timer;
+    timer.setSingleShot(true);
+
+    QEventLoop loop;
+    connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
+    connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+
+    timer.start(getTimeout());
     loop.exec();
 
+    QByteArray contents;
+
     if (timer.isActive()) { // Got reply
         timer.stop();
 
         if (reply->error() > 0) {
             showError(reply->errorString());
         } else {
-            return reply->readAll();
+            contents = reply->readAll();
         }
 
     } else { // Request timed out
+        reply->abort();
         showError(tr("Request timed out. Check your network settings."));
     }
 
-    return QByteArray();
+    reply->deleteLater();
+    return contents;
+}
+
+
+int TheGamesDBScraper::importGameInfo(QString fileName, const QHash<QString, QString> &searchNames)
+{
+    QFile dump(fileName);
+    if (!dump.open(QIODevice::ReadOnly)) {
+        QMessageBox::warning(parent, tr("Import Game Information"), tr("Could not open ") + fileName + ".");
+        return -1;
+    }
+
+    //Same layout as the replies of the API, boxart is only there if it was included
+    QJsonObject json = QJsonDocument::fromJson(dump.readAll()).object();
+    dump.close();
+
+    QJsonArray gamesArray = json.value("data").toObject().value("games").toArray();
+    if (gamesArray.isEmpty()) {
+        QMessageBox::warning(parent, tr("Import Game Information"),
+                             fileName + tr(" is not a game database from TheGamesDB."));
+        return -1;
+    }
+
+    //Index the titles and alternate titles of N64 games, a full dump has every platform
+    TitleMatcher titles;
+
+    for (int i = 0; i < gamesArray.size(); i++)
+    {
+        QJsonObject game = gamesArray.at(i).toObject();
+        if (game.value("platform").toInt() != N64Platform)
+            continue;
+
+        QStringList names(game.value("game_title").toString());
+        foreach (QJsonValue alternate, game.value("alternates").toArray())
+            names << alternate.toString();
+
+        foreach (QString name, names)
+            titles.insert(i, name);
+    }
+
+    //Names are only looked up in the cached lists
+    offline = true;
+
+    RomMetadataStore *store = RomMetadataStore::instance();
+    int found = 0, missing = 0;
+
+    for (QHash<QString, QString>::const_iterator rom = searchNames.constBegin();
+         rom != searchNames.constEnd(); ++rom)
+    {
+        //Leave games the user has picked or deleted info for alone
+        if (store->contains(rom.key()))
+            continue;
+
+        int game = titles.match(getSearchName(rom.value()));
+
+        if (game == -1) {
+            missing++;
+        } else {
+            store->insert(rom.key(), getGameData(json, game));
+            found++;
+        }
+    }
+
+    offline = false;
+
+    LOG_I(QString("Imported game info for %1 ROMs from %2, %3 not found")
+          .arg(found).arg(fileName).arg(missing));
+
+    return found;
+}
+
+
+void TheGamesDBScraper::queueGameInfo(QString identifier, QString searchName)
+{
+    if (!keepGoing || identifier == "")
+        return;
+
+    if (jobs.isEmpty()) {
+        batchTimer.start();
+
+        //Names in the game info are looked up in these lists
+        for (int i = 0; i < ListCount; i++)
+            if (!QFile::exists(getCacheLocation() + QString(ListNames[i]).toLower() + ".json"))
+                queueJob(ListJob, getListUrl(ListNames[i]), ListNames[i]);
+    }
+
+    QString gameCache = getCacheLocation() + identifier.toLower();
+    QDir().mkpath(gameCache);
+
+    RomMetadata metadata;
+    if (!RomMetadataStore::instance()->find(identifier, &metadata)) {
+        searchName = getSearchName(searchName);
+        queueJob(GameJob, getGameUrl(searchName, ""), searchName, identifier);
+        return;
+    }
+
+    QString coverFile = gameCache + "/boxart-front.";
+    if (QFile::exists(coverFile + "jpg") || QFile::exists(coverFile + "png"))
+        return;
+
+    if (metadata.boxart != "") {
+        queueJob(CoverJob, QUrl(metadata.boxart), metadata.boxart, identifier);
+    } else if (metadata.gameTitle != "") {
+        //Info imported from a dump saved without boxart, look the game up again for its cover
+        searchName = getSearchName(metadata.gameTitle);
+        queueJob(GameJob, getGameUrl(searchName, ""), searchName, identifier);
+    }
+}
+
+
+void TheGamesDBScraper::queueJob(JobType type, QUrl url, QString name, QString identifier)
+{
+    //ROMs searched under the same name wait on the same request
+    QString key = QString::number(type) + "/" + name.toLower();
+
+    if (!jobs.contains(key)) {
+        Job job;
+        job.type = type;
+        job.url = url;
+        job.name = name;
+        jobs.insert(key, job);
+
+        if (type == ListJob) {
+            queue.prepend(key);
+            listsPending++;
+        } else {
+            queue.append(key);
+        }
+    }
+
+    if (identifier != "" && !jobs[key].identifiers.contains(identifier))
+        jobs[key].identifiers << identifier;
+
+    startJobs();
+}
+
+
+bool TheGamesDBScraper::queueListUpdates(const Job &job, const QJsonObject &json)
+{
+    QJsonArray gamesArray = json.value("data").toObject().value("games").toArray();
+    int found = findGame(gamesArray, job.name);
+    if (found < 0)
+        return false;
+
+    QJsonObject foundGame = gamesArray.at(found).toObject();
+
+    //Same as convertIDs(), but the list is downloaded without waiting on it
+    bool queued = false;
+
+    for (int i = 0; i < ListCount; i++)
+    {
+        QString typeName = QString(ListNames[i]).toLower();
+        if (refreshedLists.contains(typeName))
+            continue;
+
+        const QHash<int, QString> &names = getIDList(typeName);
+
+        foreach (QJsonValue id, foundGame.value(typeName).toArray())
+        {
+            if (!names.contains(id.toInt())) {
+                refreshedLists.insert(typeName);
+                queueJob(ListJob, getListUrl(ListNames[i]), ListNames[i]);
+                queued = true;
+                break;
+            }
+        }
+    }
+
+    return queued;
+}
+
+
+void TheGamesDBScraper::reportError(QString error)
+{
+    //Aborted replies of a cancelled queue come back as errors too
+    if (!keepGoing)
+        return;
+
+    errors.append(error);
+
+    //The server is down or unreachable, the rest would fail the same way
+    if (errors.size() >= MaxErrors)
+        cancelJobs();
+}
+
+
+void TheGamesDBScraper::reportErrors()
+{
+    if (errors.isEmpty())
+        return;
+
+    //Shown without blocking, the scraper is deleted right after
+    QStringList messages = errors;
+    messages.removeDuplicates();
+
+    QString text = tr("%n download(s) failed with the following errors:", "", errors.size());
+    QMessageBox *box = new QMessageBox(QMessageBox::Warning, tr("Network Error"),
+                                       text + "\n\n" + messages.join("\n"),
+                                       QMessageBox::Ok, parent);
+    box->setAttribute(Qt::WA_DeleteOnClose);
+    box->setWindowModality(Qt::NonModal);
+    box->show();
+
+    errors.clear();
+}
+
+
+void TheGamesDBScraper::saveListCache(QFile *file, QString list, const QByteArray &data)
+{
+    //Not downloaded again this session, whether it worked or not
+    refreshedLists.insert(list.toLower());
+
+    if (data.isEmpty())
+        return;
+
+    QJsonDocument document = QJsonDocument::fromJson(data);
+    QJsonDocument result(document.object().value("data").toObject().value(list.toLower()).toObject());
+
+    file->open(QIODevice::WriteOnly);
+    file->write(result.toJson());
+    file->close();
+
+    idLists.remove(list.toLower());
+}
+
+
+void TheGamesDBScraper::setPaused(bool pause)
+{
+    paused = pause;
+
+    if (!paused)
+        startJobs();
 }
 
 
@@ -428,17 +884,24 @@ void TheGamesDBScraper::showError(QString error)
 }
 
 
-void TheGamesDBScraper::updateListCache(QFile *file, QString list)
+void TheGamesDBScraper::startJobs()
 {
-    if (keepGoing) {
-        QUrl url;
-        url.setUrl("https://api.thegamesdb.net/" + list + "?apikey=" + TheGamesDBAPIKey);
-        QString data = getUrlContents(url);
-        QJsonDocument document = QJsonDocument::fromJson(data.toUtf8());
-        QJsonDocument result(document.object().value("data").toObject().value(list.toLower()).toObject());
-
-        file->open(QIODevice::WriteOnly);
-        file->write(result.toJson());
-        file->close();
+    while (!paused && replies.size() < MaxConnections && !queue.isEmpty()) {
+        QString key = queue.takeFirst();
+        QNetworkReply *reply = getNetworkManager()->get(getRequest(jobs.value(key).url));
+        replies.insert(reply, key);
+        connect(reply, SIGNAL(finished()), this, SLOT(finishReply()));
+
+        QTimer *timer = new QTimer(reply);
+        timer->setSingleShot(true);
+        connect(timer, SIGNAL(timeout()), reply, SLOT(abort()));
+        timer->start(getTimeout());
     }
 }
+
+
+void TheGamesDBScraper::updateListCache(QFile *file, QString list)
+{
+    if (keepGoing)
+        saveListCache(file, list, getUrlContents(getListUrl(list)));
+}
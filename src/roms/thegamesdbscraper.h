@@ -32,29 +32,116 @@
 #ifndef THEGAMESDBSCRAPER_H
 #define THEGAMESDBSCRAPER_H
 
+#include <QElapsedTimer>
 #include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QPair>
+#include <QStringList>
+#include <QUrl>
 #include <QWidget>
 
-class QUrl;
+class QNetworkAccessManager;
+class QNetworkReply;
+class QNetworkRequest;
 
 
+// Downloads game info and box art from TheGamesDB into the game info cache.
+//
+// downloadGameInfo() is for a single game the user picked; it asks which
+// search result is the right one and waits for each reply.  A ROM scan
+// instead calls queueGameInfo() for every ROM and carries on: requests go
+// out over one shared network manager, a few at a time, ROMs searched
+// under the same name share one request, and a game's cover is fetched as
+// soon as its info is in while other searches are still running.
+// gameInfoUpdated() is emitted as files land in the cache and finished()
+// once the queue is closed and empty.  Failed requests don't stop the scan;
+// they are listed in one notice at the end, and after a few the rest of
+// the queue is dropped.  While paused, requests already out finish but no
+// new ones are sent.
+//
+// importGameInfo() fills in the whole library at once from a database dump
+// saved from TheGamesDB, without going on the network.
+//
+// The API address comes from Other/gamesdburl, so scans can be pointed at
+// a local server.
 class TheGamesDBScraper : public QObject
 {
     Q_OBJECT
 public:
     explicit TheGamesDBScraper(QWidget *parent = 0, bool force = false);
+    void closeQueue();
     void deleteGameInfo(QString fileName, QString identifier);
     void downloadGameInfo(QString identifier, QString searchName, QString gameID = "");
+    int importGameInfo(QString fileName, const QHash<QString, QString> &searchNames);
+    void queueGameInfo(QString identifier, QString searchName);
+    void setPaused(bool pause);
+
+signals:
+    void finished();
+    void gameInfoUpdated(QString identifier);
 
 private:
+    enum JobType {
+        ListJob,
+        GameJob,
+        CoverJob
+    };
+
+    struct Job {
+        JobType type;
+        QUrl url;
+        QString name;               //List name, search name or cover URL
+        QStringList identifiers;    //Games waiting on the result
+    };
+
+    static QString getApiUrl();
+    static const QHash<int, QString> &getIDList(QString typeName);
+    static QUrl getListUrl(QString list);
+    static QNetworkAccessManager *getNetworkManager();
+    static QNetworkRequest getRequest(QUrl url);
+    static QString getSearchName(QString searchName);
+    static int getTimeout();
+
+    void cancelJobs();
     QString convertIDs(QJsonObject foundGame, QString typeName, QString listName);
+    int findGame(QJsonArray gamesArray, QString searchName);
+    void finishCover(const Job &job, const QByteArray &data);
+    void finishGame(const Job &job, const QJsonObject &json);
+    QJsonObject getGameData(QJsonObject json, int found);
+    QUrl getGameUrl(QString searchName, QString gameID);
     QByteArray getUrlContents(QUrl url);
+    void queueJob(JobType type, QUrl url, QString name, QString identifier = "");
+    bool queueListUpdates(const Job &job, const QJsonObject &json);
+    void reportError(QString error);
+    void reportErrors();
+    void saveListCache(QFile *file, QString list, const QByteArray &data);
     void showError(QString error);
+    void startJobs();
     void updateListCache(QFile *file, QString list);
 
     bool force;
     bool keepGoing;
+    bool offline;
     QWidget *parent;
+
+    QHash<QString, Job> jobs;
+    QStringList queue;
+    QHash<QNetworkReply*, QString> replies;
+    QList<QPair<QString, QJsonObject> > parkedGames;
+    int listsPending;
+    bool queueClosed;
+    bool paused;
+    QStringList errors;
+
+    QElapsedTimer batchTimer;
+    int gamesDownloaded;
+    int coversDownloaded;
+
+private slots:
+    void finishReply();
 };
 
 #endif // THEGAMESDBSCRAPER_H
@@ -0,0 +1,254 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#include "thumbnailpack.h"
+
+#include <string.h>
+
+
+// Bump this when changing the layout of the file, older files are started over
+static const char Magic[8] = { 'M', '6', '4', 'T', 'H', 'U', 'M', 'B' };
+static const quint32 Version = 1;
+
+// Replaced and removed records a pack may carry before it is compacted on
+// open, once they also make up half of the file
+static const qint64 CompactWaste = 4 * 1024 * 1024;
+
+// Larger than any cover a view scales to.  Record headers are read back
+// from disk, so anything past this is taken as a damaged file.
+static const quint32 MaxCoverSide = 4096;
+
+struct FileHeader {
+    char magic[8];
+    quint32 version;
+    quint32 reserved;
+};
+
+// 64 bytes so the pixels that follow stay aligned
+struct RecordHeader {
+    char md5[32];
+    qint64 sourceSize;
+    qint64 sourceModified;
+    quint32 width;
+    quint32 height;
+    quint32 reserved[2];
+};
+
+
+ThumbnailPack::ThumbnailPack(const QString &fileName)
+    : file(fileName), data(NULL), mappedSize(0)
+{
+    open();
+}
+
+
+void ThumbnailPack::append(const QString &md5, qint64 sourceSize, qint64 sourceModified, const QImage &image)
+{
+    if (!file.isOpen())
+        return;
+
+    RecordHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.md5, md5.toLatin1().constData(), qMin(md5.size(), int(sizeof(header.md5))));
+    header.sourceSize = sourceSize;
+    header.sourceModified = sourceModified;
+    header.width = image.width();
+    header.height = image.height();
+
+    Record record;
+    record.offset = file.size();
+    record.sourceSize = sourceSize;
+    record.sourceModified = sourceModified;
+    record.width = image.width();
+    record.height = image.height();
+
+    file.seek(record.offset);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (int y = 0; y < image.height(); y++)
+        file.write(reinterpret_cast<const char*>(image.constScanLine(y)), image.width() * 4);
+
+    if (image.isNull())
+        index.remove(md5);
+    else
+        index.insert(md5, record);
+}
+
+
+void ThumbnailPack::compact()
+{
+    //Copy the records still in the index to a new file and put it in place of the old one
+    QFile packed(file.fileName() + ".new");
+    if (!packed.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return;
+
+    bool written = packed.write(reinterpret_cast<const char*>(data), sizeof(FileHeader)) == sizeof(FileHeader);
+
+    for (QHash<QString, Record>::const_iterator record = index.constBegin();
+         written && record != index.constEnd(); ++record)
+    {
+        qint64 length = sizeof(RecordHeader) + qint64(record->width) * record->height * 4;
+        written = packed.write(reinterpret_cast<const char*>(data + record->offset), length) == length;
+    }
+
+    packed.close();
+
+    if (!written) {
+        packed.remove();
+        return;
+    }
+
+    file.unmap(data);
+    file.close();
+    data = NULL;
+    mappedSize = 0;
+    index.clear();
+
+    if (!QFile::remove(file.fileName()) || !packed.rename(file.fileName()))
+        packed.remove();
+
+    open();
+}
+
+
+bool ThumbnailPack::find(const QString &md5, qint64 sourceSize, qint64 sourceModified, QImage *image)
+{
+    QHash<QString, Record>::const_iterator record = index.constFind(md5);
+
+    //A cover downloaded again since the thumbnail was made has to be scaled again
+    if (record == index.constEnd() ||
+        record->sourceSize != sourceSize || record->sourceModified != sourceModified)
+        return false;
+
+    qint64 pixels = record->offset + sizeof(RecordHeader);
+    int bytesPerLine = record->width * 4;
+
+    if (pixels + qint64(bytesPerLine) * record->height <= mappedSize) {
+        //Copied out of the mapping, pixmaps made from the image may outlive the pack
+        *image = QImage(static_cast<const uchar*>(data + pixels), record->width, record->height,
+                        bytesPerLine, QImage::Format_ARGB32_Premultiplied).copy();
+    } else {
+        //Added since the file was mapped
+        *image = QImage(record->width, record->height, QImage::Format_ARGB32_Premultiplied);
+        file.seek(pixels);
+        for (int y = 0; y < record->height; y++)
+            file.read(reinterpret_cast<char*>(image->scanLine(y)), bytesPerLine);
+    }
+
+    return true;
+}
+
+
+void ThumbnailPack::insert(const QString &md5, qint64 sourceSize, qint64 sourceModified, const QImage &image)
+{
+    //Would be read back as damage and cut off with everything after it
+    if (quint32(image.width()) > MaxCoverSide || quint32(image.height()) > MaxCoverSide)
+        return;
+
+    append(md5, sourceSize, sourceModified, image.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+}
+
+
+void ThumbnailPack::open()
+{
+    if (!file.open(QIODevice::ReadWrite))
+        return;
+
+    FileHeader header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+        memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+
+        file.resize(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        return;
+    }
+
+    data = file.map(0, file.size());
+    if (data == NULL)
+        return;
+
+    mappedSize = file.size();
+
+    qint64 offset = sizeof(FileHeader);
+    while (offset + qint64(sizeof(RecordHeader)) <= mappedSize) {
+        const RecordHeader *record = reinterpret_cast<const RecordHeader*>(data + offset);
+
+        //Only removals have no pixels, a record with one side zero is as damaged as an oversized one
+        if (record->width > MaxCoverSide || record->height > MaxCoverSide ||
+            (record->width == 0) != (record->height == 0))
+            break;
+
+        qint64 length = sizeof(RecordHeader) + qint64(record->width) * record->height * 4;
+        if (length > mappedSize - offset)
+            break;
+
+        QString md5 = QString::fromLatin1(record->md5, sizeof(record->md5));
+        if (record->width == 0 || record->height == 0) {
+            index.remove(md5);
+        } else {
+            Record entry;
+            entry.offset = offset;
+            entry.sourceSize = record->sourceSize;
+            entry.sourceModified = record->sourceModified;
+            entry.width = record->width;
+            entry.height = record->height;
+            index.insert(md5, entry);
+        }
+
+        offset += length;
+    }
+
+    //Drop a record that was cut short or damaged along with everything after it,
+    //so new ones are appended after whole records
+    if (offset < file.size()) {
+        file.unmap(data);
+        file.resize(offset);
+        data = file.map(0, offset);
+        mappedSize = data != NULL ? offset : 0;
+    }
+
+    //Records are only appended, so covers scraped again or removed leave their old pixels behind
+    qint64 live = sizeof(FileHeader);
+    foreach (const Record &record, index)
+        live += sizeof(RecordHeader) + qint64(record.width) * record.height * 4;
+
+    qint64 waste = mappedSize - live;
+    if (data != NULL && waste >= CompactWaste && waste * 2 >= mappedSize)
+        compact();
+}
+
+
+void ThumbnailPack::remove(const QString &md5)
+{
+    if (index.contains(md5))
+        append(md5, 0, 0, QImage());
+}
@@ -0,0 +1,81 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#ifndef THUMBNAILPACK_H
+#define THUMBNAILPACK_H
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QString>
+
+
+// One file of covers already scaled for a view, stored as raw premultiplied
+// ARGB so they can be drawn without decoding or resampling.
+//
+// The file is a header followed by records that are only ever appended:
+// a record header (md5, size and modification time of the source cover,
+// width, height) and the pixels.  A newer record for the same md5
+// replaces the older one and an empty record removes it.  The file is
+// mapped when it is opened and records are found through an index built
+// from the record headers, so looking up a cover reads no pixels.  When
+// replaced and removed records take up half of the file, it is compacted
+// the next time it is opened.
+//
+// Only use from the GUI thread.
+class ThumbnailPack
+{
+public:
+    explicit ThumbnailPack(const QString &fileName);
+
+    bool find(const QString &md5, qint64 sourceSize, qint64 sourceModified, QImage *image);
+    void insert(const QString &md5, qint64 sourceSize, qint64 sourceModified, const QImage &image);
+    void remove(const QString &md5);
+
+private:
+    struct Record {
+        qint64 offset;
+        qint64 sourceSize;
+        qint64 sourceModified;
+        int width;
+        int height;
+    };
+
+    void append(const QString &md5, qint64 sourceSize, qint64 sourceModified, const QImage &image);
+    void compact();
+    void open();
+
+    QFile file;
+    uchar *data;
+    qint64 mappedSize;
+    QHash<QString, Record> index;
+};
+
+#endif // THUMBNAILPACK_H
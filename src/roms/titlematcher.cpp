@@ -0,0 +1,245 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "titlematcher.h"
+
+#include <QFile>
+#include <QRegExp>
+
+#include <algorithm>
+
+
+// Least score a title needs to be taken as the game, out of 1
+static const double MinScore = 0.55;
+
+// Kept of the score when only one of two titles is numbered, "GoldenEye"
+// is still "GoldenEye 007" but "Mario Party" is less likely "Mario Party 2"
+static const double NumberPenalty = 0.75;
+
+// Roman numerals in sequel titles, from II
+static const char *Numerals[] = { "ii", "iii", "iv", "v", "vi" };
+static const int NumeralCount = sizeof(Numerals) / sizeof(Numerals[0]);
+
+
+QString TitleMatcher::getAlias(const QString &title)
+{
+    return getAliases().value(getKey(title), title);
+}
+
+
+const QHash<QString, QString> &TitleMatcher::getAliases()
+{
+    static QHash<QString, QString> aliases;
+    static bool loaded = false;
+
+    if (!loaded) {
+        loaded = true;
+
+        QFile aliasFile(":/other/titlealiases.txt");
+        aliasFile.open(QIODevice::ReadOnly);
+        QStringList lines = QString::fromUtf8(aliasFile.readAll()).split('\n');
+        aliasFile.close();
+
+        //One "name = TheGamesDB title" per line
+        foreach (QString line, lines)
+        {
+            int separator = line.indexOf('=');
+            if (line.trimmed().startsWith('#') || separator == -1)
+                continue;
+
+            aliases.insert(getKey(line.left(separator)), line.mid(separator + 1).trimmed());
+        }
+    }
+
+    return aliases;
+}
+
+
+QString TitleMatcher::getKey(const QString &title)
+{
+    return getWords(title).join(" ");
+}
+
+
+QStringList TitleMatcher::getNumbers(const QStringList &words)
+{
+    QStringList numbers;
+
+    foreach (QString word, words)
+        if (word.contains(QRegExp("^\\d+$")))
+            numbers << word;
+
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+
+QSet<TitleMatcher::Trigram> TitleMatcher::getTrigrams(const QStringList &words)
+{
+    QSet<Trigram> trigrams;
+    if (words.isEmpty())
+        return trigrams;
+
+    //Words are joined without spaces so MARIOKART matches Mario Kart
+    QString text = " " + words.join("") + " ";
+
+    for (int i = 0; i + 3 <= text.size(); i++)
+        trigrams.insert((Trigram(text.at(i).unicode()) << 32) |
+                        (Trigram(text.at(i + 1).unicode()) << 16) |
+                         Trigram(text.at(i + 2).unicode()));
+
+    return trigrams;
+}
+
+
+QStringList TitleMatcher::getWords(const QString &title)
+{
+    //Remove [!], (U), etc. from GoodNames
+    QString text = title;
+    text.remove(QRegExp("[\\(\\[][^\\)\\]]*[\\)\\]]"));
+
+    //Drop accents so Pokemon is Pokémon
+    QString plain;
+    foreach (QChar character, text.normalized(QString::NormalizationForm_D))
+        if (!character.isMark())
+            plain.append(character);
+
+    plain = plain.toCaseFolded();
+    plain.replace("&", " and ");
+    plain.remove(QRegExp("['\\x2019]"));
+    plain.replace(QRegExp("[^\\w]+"), " ");
+
+    QStringList words;
+
+    foreach (QString word, plain.split(' ', QString::SkipEmptyParts))
+    {
+        //"Legend of Zelda, The" is "The Legend of Zelda"
+        if (word == "the")
+            continue;
+
+        for (int i = 0; i < NumeralCount; i++)
+            if (word == Numerals[i])
+                word = QString::number(i + 2);
+
+        words << word;
+    }
+
+    return words;
+}
+
+
+void TitleMatcher::insert(int id, const QString &title)
+{
+    QStringList words = getWords(title);
+    if (words.isEmpty())
+        return;
+
+    int index = titles.size();
+    QSet<Trigram> trigrams = getTrigrams(words);
+
+    Title entry;
+    entry.id = id;
+    entry.trigramCount = trigrams.size();
+    entry.numbers = getNumbers(words);
+    titles.append(entry);
+
+    QString key = words.join(" ");
+    if (!keys.contains(key))
+        keys.insert(key, index);
+
+    foreach (Trigram trigram, trigrams)
+        postings[trigram].append(index);
+}
+
+
+int TitleMatcher::match(const QString &title, double *score) const
+{
+    QStringList words = getWords(title);
+    int found = -1;
+    double best = 0;
+
+    QHash<QString, int>::const_iterator exact = keys.constFind(words.join(" "));
+
+    if (exact != keys.constEnd()) {
+        found = *exact;
+        best = 1;
+    } else {
+        QSet<Trigram> trigrams = getTrigrams(words);
+        QStringList numbers = getNumbers(words);
+
+        //Only titles sharing a trigram with the query are scored
+        QHash<int, int> shared;
+        foreach (Trigram trigram, trigrams)
+        {
+            QHash<Trigram, QVector<int> >::const_iterator indexes = postings.constFind(trigram);
+            if (indexes == postings.constEnd())
+                continue;
+
+            foreach (int index, *indexes)
+                shared[index]++;
+        }
+
+        for (QHash<int, int>::const_iterator candidate = shared.constBegin();
+             candidate != shared.constEnd(); ++candidate)
+        {
+            const Title &entry = titles.at(candidate.key());
+
+            //A different sequel or year is a different game
+            bool renumbered = entry.numbers != numbers;
+            if (renumbered && !entry.numbers.isEmpty() && !numbers.isEmpty())
+                continue;
+
+            //Jaccard similarity, averaged with how much of the query is in the title
+            //so subtitles the search name leaves out cost less
+            int common = candidate.value();
+            double similarity = common / double(trigrams.size() + entry.trigramCount - common);
+            double coverage = common / double(trigrams.size());
+            double candidateScore = (similarity + coverage) / 2;
+
+            if (renumbered)
+                candidateScore *= NumberPenalty;
+
+            //Between equally close titles the one inserted first wins
+            if (candidateScore > best || (candidateScore == best && candidate.key() < found)) {
+                found = candidate.key();
+                best = candidateScore;
+            }
+        }
+
+        if (best < MinScore)
+            found = -1;
+    }
+
+    if (score)
+        *score = found == -1 ? 0 : best;
+
+    return found == -1 ? -1 : titles.at(found).id;
+}
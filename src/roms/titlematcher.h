@@ -0,0 +1,83 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef TITLEMATCHER_H
+#define TITLEMATCHER_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+
+// Finds the game title closest to a GoodName or search name among a set of
+// candidate titles, such as the results of one TheGamesDB search or every
+// N64 title in a database dump.
+//
+// Titles are compared by their key: GoodName tags, accents, punctuation,
+// "the" and case are dropped and roman numerals become digits, so
+// "Legend of Zelda, The - Ocarina of Time (U)" and "The Legend of Zelda:
+// Ocarina of Time" share a key.  Titles without an equal key are scored by
+// the trigrams they share with the query, and a title numbered differently
+// ("Mario Party 2" against "Mario Party 3") never matches.
+//
+// getAlias() maps names TheGamesDB does not know to the ones it does, from
+// the alias table in the resources.
+class TitleMatcher
+{
+public:
+    void insert(int id, const QString &title);
+    int match(const QString &title, double *score = 0) const;
+
+    static QString getAlias(const QString &title);
+    static QString getKey(const QString &title);
+
+private:
+    typedef quint64 Trigram;
+
+    struct Title {
+        int id;
+        int trigramCount;
+        QStringList numbers;
+    };
+
+    static const QHash<QString, QString> &getAliases();
+    static QStringList getNumbers(const QStringList &words);
+    static QSet<Trigram> getTrigrams(const QStringList &words);
+    static QStringList getWords(const QString &title);
+
+    QVector<Title> titles;
+    QHash<QString, int> keys;
+    QHash<Trigram, QVector<int> > postings;
+};
+
+#endif // TITLEMATCHER_H
@@ -0,0 +1,184 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "settingsstore.h"
+
+#include "global.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+
+
+// Delay before changed settings are written to disk
+static const int WriteDelay = 500;
+
+
+static void readValue(const char *key, bool defaultValue, bool &value)
+{
+    value = SETTINGS.value(key, defaultValue ? "true" : "").toString() == "true";
+}
+
+
+static void readValue(const char *key, int defaultValue, int &value)
+{
+    value = SETTINGS.value(key, defaultValue).toInt();
+}
+
+
+static void readValue(const char *key, const char *defaultValue, QString &value)
+{
+    value = SETTINGS.value(key, defaultValue).toString();
+}
+
+
+static void readValue(const char *key, const char *defaultValue, QStringList &value)
+{
+    value = SETTINGS.value(key, defaultValue).toString().split("|");
+}
+
+
+static void writeValue(const char *key, bool value)
+{
+    if (value)
+        SETTINGS.setValue(key, true);
+    else
+        SETTINGS.setValue(key, "");
+}
+
+
+static void writeValue(const char *key, int value)
+{
+    SETTINGS.setValue(key, value);
+}
+
+
+static void writeValue(const char *key, const QString &value)
+{
+    SETTINGS.setValue(key, value);
+}
+
+
+static void writeValue(const char *key, const QStringList &value)
+{
+    SETTINGS.setValue(key, value.join("|"));
+}
+
+
+SettingsStore::SettingsStore() : QObject(0), snapshot()
+{
+    writeTimer = new QTimer(this);
+    writeTimer->setSingleShot(true);
+    writeTimer->setInterval(WriteDelay);
+
+    connect(writeTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(flush()));
+
+    reload();
+}
+
+
+void SettingsStore::flush()
+{
+    writeTimer->stop();
+
+    if (dirtyKeys.isEmpty())
+        return;
+
+#define SETTINGS_WRITE(type, name, key, defaultValue) \
+    if (dirtyKeys.contains(key)) \
+        writeValue(key, snapshot.name);
+    SETTINGS_SCHEMA(SETTINGS_WRITE)
+#undef SETTINGS_WRITE
+
+    dirtyKeys.clear();
+}
+
+
+const SettingsSnapshot &SettingsStore::get() const
+{
+    return snapshot;
+}
+
+
+SettingsStore *SettingsStore::instance()
+{
+    static SettingsStore *store = new SettingsStore;
+    return store;
+}
+
+
+void SettingsStore::reload()
+{
+    //Pending changes would otherwise be lost or written over newer values
+    flush();
+
+    SettingsSnapshot values;
+
+#define SETTINGS_READ(type, name, key, defaultValue) \
+    readValue(key, defaultValue, values.name);
+    SETTINGS_SCHEMA(SETTINGS_READ)
+#undef SETTINGS_READ
+
+    bool modified = false;
+
+#define SETTINGS_COMPARE(type, name, key, defaultValue) \
+    if (values.name != snapshot.name) \
+        modified = true;
+    SETTINGS_SCHEMA(SETTINGS_COMPARE)
+#undef SETTINGS_COMPARE
+
+    snapshot = values;
+
+    if (modified)
+        emit changed();
+}
+
+
+void SettingsStore::update(const SettingsSnapshot &values)
+{
+    bool modified = false;
+
+#define SETTINGS_UPDATE(type, name, key, defaultValue) \
+    if (values.name != snapshot.name) { \
+        dirtyKeys.insert(key); \
+        modified = true; \
+    }
+    SETTINGS_SCHEMA(SETTINGS_UPDATE)
+#undef SETTINGS_UPDATE
+
+    if (!modified)
+        return;
+
+    snapshot = values;
+    writeTimer->start();
+
+    emit changed();
+}
@@ -0,0 +1,122 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+class QTimer;
+
+
+// Settings read on hot paths while building views, with their QSettings
+// key and default value.  Booleans follow the rest of the code and are
+// stored as "true" or an empty string.
+#define SETTINGS_SCHEMA(X) \
+    X(QString,     viewLayout,              "View/layout",              "table") \
+    X(bool,        showFacets,              "View/facets",              false) \
+    X(QString,     theme,                   "theme",                    "Default") \
+    X(bool,        downloadInfo,            "Other/downloadinfo",       false) \
+    X(int,         coverCacheSize,          "Other/covercachesize",     64) \
+    X(bool,        gamingMode,              "Other/gamingmode",         false) \
+    X(int,         stallThreshold,          "Other/stallthreshold",     0) \
+    X(bool,        gridAutoColumns,         "Grid/autocolumns",         true) \
+    X(int,         gridColumnCount,         "Grid/columncount",         4) \
+    X(QString,     gridImageSize,           "Grid/imagesize",           "Medium") \
+    X(bool,        gridLabel,               "Grid/label",               true) \
+    X(QString,     gridLabelText,           "Grid/labeltext",           "Filename") \
+    X(QString,     gridLabelColor,          "Grid/labelcolor",          "White") \
+    X(QString,     gridActiveColor,         "Grid/activecolor",         "Cyan") \
+    X(QString,     gridInactiveColor,       "Grid/inactivecolor",       "Black") \
+    X(QString,     gridTheme,               "Grid/theme",               "Normal") \
+    X(QString,     gridBackground,          "Grid/background",          "") \
+    X(QString,     gridSort,                "Grid/sort",                "Filename") \
+    X(QString,     gridSortDirection,       "Grid/sortdirection",       "ascending") \
+    X(QString,     listImageSize,           "List/imagesize",           "Medium") \
+    X(QStringList, listColumns,             "List/columns",             "Filename|Internal Name|Size") \
+    X(bool,        listDisplayCover,        "List/displaycover",        false) \
+    X(bool,        listFirstItemHeader,     "List/firstitemheader",     true) \
+    X(QString,     listTextSize,            "List/textsize",            "Medium") \
+    X(QString,     listSort,                "List/sort",                "Filename") \
+    X(QString,     listSortDirection,       "List/sortdirection",       "ascending") \
+    X(QString,     tableImageSize,          "Table/imagesize",          "Medium") \
+    X(QStringList, tableColumns,            "Table/columns",            "Filename|Size") \
+    X(bool,        tableStretchFirstColumn, "Table/stretchfirstcolumn", true) \
+    X(QString,     tableSort,               "Table/sort",               "")
+
+
+struct SettingsSnapshot {
+#define SETTINGS_FIELD(type, name, key, defaultValue) type name;
+    SETTINGS_SCHEMA(SETTINGS_FIELD)
+#undef SETTINGS_FIELD
+};
+
+
+// Process-wide copy of the settings in SETTINGS_SCHEMA.
+//
+// Reads are plain field reads of the snapshot.  Changes go through
+// update(), which emits changed() right away and writes the changed keys
+// to QSettings shortly after, so a burst of changes costs one write.
+// Code that still uses SETTINGS for these keys (the settings dialog)
+// should be bracketed with flush() before and reload() after.
+//
+// Only use from the GUI thread.
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SettingsStore *instance();
+
+    const SettingsSnapshot &get() const;
+    void reload();
+    void update(const SettingsSnapshot &values);
+
+public slots:
+    void flush();
+
+signals:
+    void changed();
+
+private:
+    SettingsStore();
+
+    SettingsSnapshot snapshot;
+    QSet<QString> dirtyKeys;
+    QTimer *writeTimer;
+};
+
+#define CACHED_SETTINGS (SettingsStore::instance()->get())
+
+#endif // SETTINGSSTORE_H
@@ -0,0 +1,280 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#include "stallwatchdog.h"
+
+#include "global.h"
+#include "error.h"
+
+#include <QCoreApplication>
+#include <QMap>
+#include <QMutexLocker>
+#include <QThread>
+
+
+// How often the monitor looks at the GUI thread, in ms
+static const int BeatInterval = 25;
+
+// Upper bounds of the histogram buckets in ms, the last bucket is open
+static const int HistogramBounds[] = { 100, 250, 500, 1000, 2500, 5000 };
+static const int HistogramBoundCount = sizeof(HistogramBounds) / sizeof(HistogramBounds[0]);
+
+// Stalls listed one by one in the report
+static const int WorstStallCount = 10;
+
+
+class StallMonitor : public QThread
+{
+public:
+    explicit StallMonitor(StallWatchdog *watchdog) : watchdog(watchdog), stopping(0) {}
+
+    void stop()
+    {
+        stopping.store(1);
+        wait();
+        stopping.store(0);
+    }
+
+protected:
+    void run()
+    {
+        while (stopping.load() == 0) {
+            msleep(BeatInterval);
+
+            int threshold = watchdog->threshold.load();
+            if (threshold <= 0)
+                continue;
+
+            QMutexLocker locker(&watchdog->beatMutex);
+            qint64 now = watchdog->clock.elapsed();
+
+            if (watchdog->beatPending) {
+                //Note what the GUI thread is busy with while it still is
+                if (!watchdog->beatSampled && now - watchdog->beatPosted >= threshold) {
+                    watchdog->beatOperation = watchdog->operation.load();
+                    watchdog->beatSampled = true;
+                }
+                continue;
+            }
+
+            watchdog->beatPosted = now;
+            watchdog->beatPending = true;
+            watchdog->beatSampled = false;
+            QMetaObject::invokeMethod(watchdog, "beat", Qt::QueuedConnection, Q_ARG(qint64, now));
+        }
+    }
+
+private:
+    StallWatchdog *watchdog;
+    QAtomicInt stopping;
+};
+
+
+StallWatchdog::StallWatchdog() : QObject(0)
+{
+    beatPosted = 0;
+    beatPending = false;
+    beatSampled = false;
+    beatOperation = NULL;
+    started = false;
+    paused = false;
+    stalledTime = 0;
+    histogram.fill(0, HistogramBoundCount + 1);
+
+    clock.start();
+    monitor = new StallMonitor(this);
+
+    connect(SettingsStore::instance(), SIGNAL(changed()), this, SLOT(updateThreshold()));
+    connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(stop()));
+}
+
+
+void StallWatchdog::beat(qint64 posted)
+{
+    QMutexLocker locker(&beatMutex);
+    qint64 latency = clock.elapsed() - posted;
+    const char *label = beatSampled ? beatOperation : operation.load();
+    beatPending = false;
+    locker.unlock();
+
+    if (latency < threshold.load())
+        return;
+
+    Stall stall;
+    stall.started = QDateTime::currentDateTime().addMSecs(-latency);
+    stall.duration = int(latency);
+    stall.operation = label != NULL ? QString(label) : QString("(no operation)");
+    recordStall(stall);
+}
+
+
+QString StallWatchdog::getReport() const
+{
+    int count = 0;
+    foreach (int bucket, histogram)
+        count += bucket;
+
+    QString report = QString("Event loop stalls: %1, %2 ms in total, threshold %3 ms\n")
+                       .arg(count).arg(stalledTime).arg(threshold.load());
+    if (count == 0)
+        return report;
+
+    report += "\nLength\n";
+    for (int i = 0; i < histogram.size(); i++) {
+        if (histogram[i] == 0)
+            continue;
+
+        QString range;
+        if (i == 0)
+            range = QString("< %1 ms").arg(HistogramBounds[0]);
+        else if (i == HistogramBoundCount)
+            range = QString(">= %1 ms").arg(HistogramBounds[i - 1]);
+        else
+            range = QString("%1-%2 ms").arg(HistogramBounds[i - 1]).arg(HistogramBounds[i]);
+
+        report += QString("  %1 %2\n").arg(range, -14).arg(histogram[i]);
+    }
+
+    report += "\nWorst stalls\n";
+    foreach (Stall stall, worstStalls)
+        report += QString("  %1 %2 ms  %3\n")
+                    .arg(stall.started.toString("yyyy-MM-dd hh:mm:ss.zzz"))
+                    .arg(stall.duration, 6).arg(stall.operation);
+
+    //Operations that stalled the longest altogether first
+    QMultiMap<qint64, QString> byDuration;
+    for (QHash<QString, OperationTotal>::const_iterator total = operationTotals.begin();
+         total != operationTotals.end(); ++total)
+        byDuration.insert(total->duration, total.key());
+
+    report += "\nBy operation\n";
+    QMapIterator<qint64, QString> next(byDuration);
+    next.toBack();
+    while (next.hasPrevious()) {
+        next.previous();
+        const OperationTotal &total = operationTotals[next.value()];
+        report += QString("  %1 stalls, %2 ms  %3\n").arg(total.count, 4).arg(total.duration, 6).arg(next.value());
+    }
+
+    return report;
+}
+
+
+StallWatchdog *StallWatchdog::instance()
+{
+    static StallWatchdog *watchdog = new StallWatchdog;
+    return watchdog;
+}
+
+
+void StallWatchdog::recordStall(const Stall &stall)
+{
+    int bucket = 0;
+    while (bucket < HistogramBoundCount && stall.duration >= HistogramBounds[bucket])
+        bucket++;
+
+    histogram[bucket]++;
+    stalledTime += stall.duration;
+
+    OperationTotal &total = operationTotals[stall.operation];
+    total.count++;
+    total.duration += stall.duration;
+
+    //Longest first, only the worst few are kept
+    int position = 0;
+    while (position < worstStalls.size() && worstStalls[position].duration >= stall.duration)
+        position++;
+
+    if (position < WorstStallCount) {
+        worstStalls.insert(position, stall);
+        if (worstStalls.size() > WorstStallCount)
+            worstStalls.removeLast();
+    }
+
+    QString message = QString("Event loop stalled for %1 ms at %2 in %3")
+                        .arg(stall.duration).arg(stall.started.toString("hh:mm:ss.zzz")).arg(stall.operation);
+    LOG_V(message);
+}
+
+
+void StallWatchdog::setPaused(bool pause)
+{
+    paused = pause;
+    updateMonitor();
+}
+
+
+void StallWatchdog::start()
+{
+    started = true;
+    updateThreshold();
+}
+
+
+void StallWatchdog::stop()
+{
+    started = false;
+    updateMonitor();
+
+    foreach (QString line, getReport().split("\n", QString::SkipEmptyParts))
+        LOG_I(line);
+}
+
+
+void StallWatchdog::updateMonitor()
+{
+    bool run = started && !paused && threshold.load() > 0;
+
+    if (run && !monitor->isRunning())
+        monitor->start();
+    else if (!run && monitor->isRunning())
+        monitor->stop();
+}
+
+
+void StallWatchdog::updateThreshold()
+{
+    threshold.store(qMax(0, CACHED_SETTINGS.stallThreshold));
+    updateMonitor();
+}
+
+
+StallOperation::StallOperation(const char *label)
+{
+    StallWatchdog *watchdog = StallWatchdog::instance();
+    previous = watchdog->operation.load();
+    watchdog->operation.store(label);
+}
+
+
+StallOperation::~StallOperation()
+{
+    StallWatchdog::instance()->operation.store(previous);
+}
@@ -0,0 +1,130 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class StallMonitor;
+
+
+// Measures how long the GUI thread takes to get to a posted event.
+//
+// A helper thread posts a heartbeat to the GUI thread and waits for it to
+// be handled before posting the next.  A heartbeat that waits longer than
+// the Other/stallthreshold setting (ms, 0 turns the watchdog off) is
+// recorded as a stall, with the time it began and the operation the GUI
+// thread was in, as named by the innermost StallOperation.  The summary
+// from getReport() is written to the log on exit and shown in the log
+// dialog.
+//
+// It is off unless a threshold is set, and the helper thread only runs
+// while it is on and not paused, so a running game isn't woken for it.
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stall {
+        QDateTime started;
+        int duration; //ms
+        QString operation;
+    };
+
+    static StallWatchdog *instance();
+
+    QString getReport() const;
+    void setPaused(bool pause);
+    void start();
+
+private:
+    struct OperationTotal {
+        int count;
+        qint64 duration;
+    };
+
+    StallWatchdog();
+    void recordStall(const Stall &stall);
+    void updateMonitor();
+
+    friend class StallMonitor;
+    friend class StallOperation;
+
+    StallMonitor *monitor;
+    QElapsedTimer clock;
+    QAtomicInt threshold;
+    QAtomicPointer<const char> operation;
+    bool started;
+    bool paused;
+
+    //Shared with the monitor thread
+    QMutex beatMutex;
+    qint64 beatPosted;
+    bool beatPending;
+    bool beatSampled;
+    const char *beatOperation;
+
+    QVector<int> histogram;
+    QList<Stall> worstStalls;
+    QHash<QString, OperationTotal> operationTotals;
+    qint64 stalledTime;
+
+private slots:
+    void beat(qint64 posted);
+    void stop();
+    void updateThreshold();
+};
+
+
+// Names what the GUI thread is doing while it is in scope, so stalls can
+// be put down to it.  The label must outlive the watchdog, so pass a
+// string literal.
+class StallOperation
+{
+public:
+    explicit StallOperation(const char *label);
+    ~StallOperation();
+
+private:
+    const char *previous;
+};
+
+#endif // STALLWATCHDOG_H
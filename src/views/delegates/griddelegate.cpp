@@ -0,0 +1,175 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "griddelegate.h"
+
+#include "../../global.h"
+#include "../../common.h"
+
+#include "../../roms/covercache.h"
+#include "../../roms/coverloader.h"
+#include "../../roms/romfiltermodel.h"
+
+#include <QPainter>
+#include <QPixmapCache>
+#include <qdrawutil.h>
+
+
+// Space above the cover and between the cover and its label
+static const int ItemMargin = 11;
+static const int LabelSpacing = 4;
+
+
+GridDelegate::GridDelegate(QObject *parent) : QStyledItemDelegate(parent)
+{
+    updateSettings();
+}
+
+
+void GridDelegate::clearCover(const QString &md5)
+{
+    CoverCache::instance()->remove(md5);
+    CoverLoader::instance()->clearCover(md5);
+}
+
+
+void GridDelegate::drawShadow(QPainter *painter, const QRect &coverRect, bool active) const
+{
+    //Stretch the cached sprite around the cover: corners as they are, edges along the sides
+    int radius = getShadowRadius(active);
+    QPixmap shadow = getShadow(active);
+
+    QRect shadowRect = coverRect.adjusted(-radius, -radius, radius, radius);
+    int margin = qMin(radius * 2, qMin(shadowRect.width(), shadowRect.height()) / 2);
+
+    qDrawBorderPixmap(painter, shadowRect, QMargins(margin, margin, margin, margin),
+                      shadow, shadow.rect(), QMargins(radius * 2, radius * 2, radius * 2, radius * 2));
+}
+
+
+QPixmap GridDelegate::getCover(const Rom *rom, CoverLoader::CoverPriority priority) const
+{
+    QString key = CoverCache::getKey(rom->romMD5, imageSize, CoverLoader::StretchBoxArt);
+
+    QPixmap image;
+    if (CoverCache::instance()->find(key, &image))
+        return image;
+
+    QImage cover;
+    switch (CoverLoader::instance()->loadCover(key, rom->romMD5, imageSize, CoverLoader::StretchBoxArt, &cover, priority)) {
+    case CoverLoader::CoverPending:
+        return CoverLoader::getPlaceholder(imageSize);
+    case CoverLoader::CoverMissing:
+        return getNotFound();
+    case CoverLoader::CoverReady:
+        break;
+    }
+
+    image = QPixmap::fromImage(cover);
+    CoverCache::instance()->insert(key, image);
+    return image;
+}
+
+
+QPixmap GridDelegate::getNotFound() const
+{
+    QString key = "grid-cover/not-found/" + QString::number(imageSize.width()) + "x" + QString::number(imageSize.height());
+
+    QPixmap image;
+    if (!QPixmapCache::find(key, &image)) {
+        image = QPixmap(":/images/not-found.png").scaled(imageSize, Qt::IgnoreAspectRatio,
+                                                         Qt::SmoothTransformation);
+        QPixmapCache::insert(key, image);
+    }
+
+    return image;
+}
+
+
+void GridDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const Rom *rom = static_cast<const RomFilterModel*>(index.model())->getRom(index);
+    if (rom == NULL)
+        return;
+
+    QPixmap cover = getCover(rom);
+
+    QRect imageRect(option.rect.x() + (option.rect.width() - imageSize.width()) / 2,
+                    option.rect.y() + ItemMargin, imageSize.width(), imageSize.height());
+    QRect coverRect(QPoint(0, 0), cover.size());
+    coverRect.moveCenter(imageRect.center());
+
+    bool active = option.state & QStyle::State_Selected;
+    drawShadow(painter, coverRect, active);
+    painter->drawPixmap(coverRect.topLeft(), cover);
+
+    if (showLabel) {
+        //Don't allow label to be wider than image
+        QRect textRect(imageRect.left(), imageRect.bottom() + LabelSpacing,
+                       imageRect.width(), option.rect.bottom() - imageRect.bottom() - LabelSpacing);
+
+        painter->save();
+        painter->setFont(labelFont);
+        painter->setPen(labelColor);
+        painter->drawText(textRect, Qt::AlignHCenter | Qt::AlignTop | Qt::TextWordWrap,
+                          getRomInfo(labelField, rom));
+        painter->restore();
+    }
+}
+
+
+void GridDelegate::requestCover(const QModelIndex &index, CoverLoader::CoverPriority priority) const
+{
+    const Rom *rom = static_cast<const RomFilterModel*>(index.model())->getRom(index);
+    if (rom != NULL)
+        getCover(rom, priority);
+}
+
+
+QSize GridDelegate::sizeHint(const QStyleOptionViewItem &, const QModelIndex &) const
+{
+    return itemSize;
+}
+
+
+void GridDelegate::updateSettings()
+{
+    imageSize = getImageSize("Grid");
+    itemSize = QSize(getGridSize("width"), getGridSize("height"));
+
+    showLabel = CACHED_SETTINGS.gridLabel;
+    labelField = getRomFieldId(CACHED_SETTINGS.gridLabelText);
+    labelColor = getColor(CACHED_SETTINGS.gridLabelColor);
+
+    labelFont = QFont();
+    labelFont.setBold(true);
+    labelFont.setPixelSize(getGridSize("font"));
+}
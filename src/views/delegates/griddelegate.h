@@ -0,0 +1,74 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef GRIDDELEGATE_H
+#define GRIDDELEGATE_H
+
+#include "../../roms/coverloader.h"
+#include "../../roms/romfield.h"
+
+#include <QColor>
+#include <QFont>
+#include <QPixmap>
+#include <QSize>
+#include <QStyledItemDelegate>
+
+
+// Paints one cell of the grid view: the cover with its drop shadow and
+// the optional label below it.  The settings that decide the look are
+// read once in updateSettings(), and scaled covers (in CoverCache) and
+// the shadow sprites are cached so scrolling only blits pixmaps.
+class GridDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit GridDelegate(QObject *parent = 0);
+    void clearCover(const QString &md5);
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    void requestCover(const QModelIndex &index, CoverLoader::CoverPriority priority) const;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    void updateSettings();
+
+private:
+    void drawShadow(QPainter *painter, const QRect &coverRect, bool active) const;
+    QPixmap getCover(const Rom *rom, CoverLoader::CoverPriority priority = CoverLoader::VisiblePriority) const;
+    QPixmap getNotFound() const;
+
+    QSize imageSize;
+    QSize itemSize;
+    bool showLabel;
+    RomFieldId labelField;
+    QColor labelColor;
+    QFont labelFont;
+};
+
+#endif // GRIDDELEGATE_H
@@ -0,0 +1,293 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "listdelegate.h"
+
+#include "../../global.h"
+#include "../../common.h"
+
+#include "../../roms/covercache.h"
+#include "../../roms/coverloader.h"
+#include "../../roms/romcollectionmodel.h"
+#include "../../roms/romfiltermodel.h"
+
+#include <QAbstractTextDocumentLayout>
+#include <QPainter>
+#include <QPixmapCache>
+
+
+// Horizontal space before the cover, added again to the selected row
+static const int Indent = 20;
+
+// Space around the contents of a row and between the cover and the text
+static const int ItemMargin = 9;
+static const int CoverSpacing = 16;
+
+// Rows whose laid out text is kept
+static const int DocumentCacheSize = 512;
+
+
+ListDelegate::ListDelegate(QObject *parent) : QStyledItemDelegate(parent)
+{
+    rowWidth = 0;
+    documents.setMaxCost(DocumentCacheSize);
+
+    updateSettings();
+}
+
+
+void ListDelegate::clearRow(const QString &md5)
+{
+    documents.remove(md5);
+    heights.remove(md5);
+    CoverCache::instance()->remove(md5);
+    CoverLoader::instance()->clearCover(md5);
+}
+
+
+void ListDelegate::clearRows()
+{
+    documents.clear();
+    heights.clear();
+}
+
+
+QPixmap ListDelegate::getCover(const Rom *rom, CoverLoader::CoverPriority priority) const
+{
+    QString key = CoverCache::getKey(rom->romMD5, imageSize, CoverLoader::FitCover);
+
+    QPixmap image;
+    if (CoverCache::instance()->find(key, &image))
+        return image;
+
+    QImage cover;
+    switch (CoverLoader::instance()->loadCover(key, rom->romMD5, imageSize, CoverLoader::FitCover, &cover, priority)) {
+    case CoverLoader::CoverPending:
+        return CoverLoader::getPlaceholder(imageSize);
+    case CoverLoader::CoverMissing:
+        return getNotFound();
+    case CoverLoader::CoverReady:
+        break;
+    }
+
+    image = QPixmap::fromImage(cover);
+    CoverCache::instance()->insert(key, image);
+    return image;
+}
+
+
+QTextDocument *ListDelegate::getDocument(const Rom *rom, int width) const
+{
+    QTextDocument *document = documents.object(rom->romMD5);
+
+    if (document == NULL) {
+        document = new QTextDocument();
+        document->setDefaultFont(textFont);
+        document->setDocumentMargin(0);
+        document->setHtml(getText(rom));
+        documents.insert(rom->romMD5, document);
+    }
+
+    //Only wrap the text again when the list was resized
+    if (document->textWidth() != width)
+        document->setTextWidth(width);
+
+    return document;
+}
+
+
+QPixmap ListDelegate::getNotFound() const
+{
+    QString key = "list-cover/not-found/" + QString::number(imageSize.width()) + "x" + QString::number(imageSize.height());
+
+    QPixmap image;
+    if (!QPixmapCache::find(key, &image)) {
+        image = QPixmap(":/images/not-found.png").scaled(imageSize, Qt::KeepAspectRatio,
+                                                         Qt::SmoothTransformation);
+        QPixmapCache::insert(key, image);
+    }
+
+    return image;
+}
+
+
+QString ListDelegate::getText(const Rom *rom) const
+{
+    QString listText = "";
+
+    for (int i = 0; i < columns.size(); i++)
+    {
+        QString addition = "";
+
+        if (i == 0 && firstItemHeader)
+            addition += "<h2 style='line-height:120%;margin:0;padding:0;'>";
+        else
+            addition += "<div style='line-height:120%;margin:0;padding:0;'><b>" + columnNames.at(i) + ":</b> ";
+
+        addition += getRomInfo(columns.at(i), rom, true);
+
+        if (i == 0 && firstItemHeader)
+            addition += "</h2>";
+        else
+            addition += "</div>";
+
+        if (addition.right(12) != ":</b> </div>")
+            listText += addition;
+    }
+
+    return listText;
+}
+
+
+int ListDelegate::getTextWidth(int rowWidth) const
+{
+    int width = rowWidth - Indent * 2 - ItemMargin * 2;
+
+    if (showCover)
+        width -= imageSize.width() + CoverSpacing;
+
+    return qMax(width, 1);
+}
+
+
+void ListDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const Rom *rom = static_cast<const RomFilterModel*>(index.model())->getRom(index);
+    if (rom == NULL)
+        return;
+
+    QRect rect = option.rect.adjusted(0, 0, 0, -1);
+
+    //Give current left margin to stand out
+    int x = rect.x() + Indent + ItemMargin;
+    if (option.state & QStyle::State_Selected)
+        x += Indent;
+
+    if (showCover) {
+        QPixmap cover = getCover(rom);
+        QRect coverRect(QPoint(0, 0), cover.size());
+        coverRect.moveCenter(QPoint(x + imageSize.width() / 2, rect.center().y()));
+
+        painter->drawPixmap(coverRect.topLeft(), cover);
+        x += imageSize.width() + CoverSpacing;
+    }
+
+    int width = getTextWidth(option.rect.width());
+    QTextDocument *document = getDocument(rom, width);
+    int y = rect.y() + (rect.height() - int(document->size().height())) / 2;
+
+    QAbstractTextDocumentLayout::PaintContext context;
+    context.palette = option.palette;
+    if (textColor.isValid())
+        context.palette.setColor(QPalette::Text, textColor);
+    context.clip = QRectF(0, 0, width, rect.bottom() - y);
+
+    painter->save();
+    painter->translate(x, y);
+    painter->setClipRect(context.clip);
+    document->documentLayout()->draw(painter, context);
+    painter->restore();
+
+    //Separator between this row and the next
+    if (index.row() < index.model()->rowCount() - 1) {
+        painter->save();
+        painter->setPen(separatorColor);
+        painter->drawLine(option.rect.bottomLeft(), option.rect.bottomRight());
+        painter->restore();
+    }
+}
+
+
+void ListDelegate::requestCover(const QModelIndex &index, CoverLoader::CoverPriority priority) const
+{
+    if (!showCover)
+        return;
+
+    const Rom *rom = static_cast<const RomFilterModel*>(index.model())->getRom(index);
+    if (rom != NULL)
+        getCover(rom, priority);
+}
+
+
+void ListDelegate::setRowWidth(int width)
+{
+    if (width != rowWidth)
+        heights.clear();
+
+    rowWidth = width;
+}
+
+
+QSize ListDelegate::sizeHint(const QStyleOptionViewItem &, const QModelIndex &index) const
+{
+    //Every row is asked for on each layout, so only measure a row once per width
+    QString md5 = index.data(RomCollectionModel::MD5Role).toString();
+
+    QHash<QString, int>::const_iterator cached = heights.constFind(md5);
+    if (cached != heights.constEnd())
+        return QSize(rowWidth, *cached);
+
+    int height = showCover ? imageSize.height() : 0;
+
+    const Rom *rom = static_cast<const RomFilterModel*>(index.model())->getRom(index);
+    if (rom != NULL)
+        height = qMax(height, int(getDocument(rom, getTextWidth(rowWidth))->size().height()));
+
+    height += ItemMargin * 2 + 1;
+    heights.insert(md5, height);
+
+    return QSize(rowWidth, height);
+}
+
+
+void ListDelegate::updateSettings()
+{
+    imageSize = getImageSize("List");
+    showCover = CACHED_SETTINGS.listDisplayCover;
+    firstItemHeader = CACHED_SETTINGS.listFirstItemHeader;
+
+    columnNames = CACHED_SETTINGS.listColumns;
+    columns = getRomFieldIds(columnNames);
+
+    textFont = QFont();
+    textFont.setPointSize(getTextSize());
+
+    if (CACHED_SETTINGS.theme == "Dark") {
+        textColor = QColor("#EEE");
+        separatorColor = Qt::black;
+    } else {
+        textColor = QColor();
+        separatorColor = Qt::gray;
+    }
+
+    documents.clear();
+    heights.clear();
+}
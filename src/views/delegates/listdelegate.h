@@ -0,0 +1,90 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#ifndef LISTDELEGATE_H
+#define LISTDELEGATE_H
+
+#include "../../roms/coverloader.h"
+#include "../../roms/romfield.h"
+
+#include <QCache>
+#include <QColor>
+#include <QFont>
+#include <QHash>
+#include <QPixmap>
+#include <QSize>
+#include <QStringList>
+#include <QStyledItemDelegate>
+#include <QTextDocument>
+#include <QVector>
+
+
+// Paints one row of the list view: the optional cover followed by the
+// chosen fields as rich text.  The text of a row is laid out once and
+// kept until the row changes, and only laid out again when the width of
+// the list changes.  Rows are as high as their text, and the height of
+// each row is kept for the current width.
+class ListDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit ListDelegate(QObject *parent = 0);
+    void clearRow(const QString &md5);
+    void clearRows();
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    void requestCover(const QModelIndex &index, CoverLoader::CoverPriority priority) const;
+    void setRowWidth(int width);
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    void updateSettings();
+
+private:
+    QPixmap getCover(const Rom *rom, CoverLoader::CoverPriority priority = CoverLoader::VisiblePriority) const;
+    QTextDocument *getDocument(const Rom *rom, int width) const;
+    QPixmap getNotFound() const;
+    QString getText(const Rom *rom) const;
+    int getTextWidth(int rowWidth) const;
+
+    int rowWidth;
+    QSize imageSize;
+    bool showCover;
+    bool firstItemHeader;
+    QColor separatorColor;
+    QColor textColor;
+    QFont textFont;
+    QStringList columnNames;
+    QVector<RomFieldId> columns;
+
+    mutable QCache<QString, QTextDocument> documents;
+    mutable QHash<QString, int> heights;
+};
+
+#endif // LISTDELEGATE_H
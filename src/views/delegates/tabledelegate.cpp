@@ -0,0 +1,111 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "tabledelegate.h"
+
+#include "../../common.h"
+
+#include "../../roms/covercache.h"
+#include "../../roms/coverloader.h"
+#include "../../roms/romtablemodel.h"
+
+#include <QPainter>
+
+
+TableDelegate::TableDelegate(QObject *parent) : QStyledItemDelegate(parent)
+{
+    updateSettings();
+}
+
+
+void TableDelegate::clearCover(const QString &md5)
+{
+    CoverCache::instance()->remove(md5);
+    CoverLoader::instance()->clearCover(md5);
+}
+
+
+QPixmap TableDelegate::getCover(const Rom *rom, CoverLoader::CoverPriority priority) const
+{
+    QString key = CoverCache::getKey(rom->romMD5, imageSize, CoverLoader::FitCover);
+
+    QPixmap image;
+    if (CoverCache::instance()->find(key, &image))
+        return image;
+
+    //The table leaves the cell empty until the cover is read, and when there is none
+    QImage cover;
+    if (CoverLoader::instance()->loadCover(key, rom->romMD5, imageSize, CoverLoader::FitCover, &cover, priority)
+            != CoverLoader::CoverReady)
+        return QPixmap();
+
+    image = QPixmap::fromImage(cover);
+    CoverCache::instance()->insert(key, image);
+    return image;
+}
+
+
+void TableDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    //Background, selection and text as usual, the cover column has no text
+    QStyledItemDelegate::paint(painter, option, index);
+
+    const RomTableModel *model = static_cast<const RomTableModel*>(index.model());
+    if (model->getColumnField(index.column()) != GameCoverField)
+        return;
+
+    const Rom *rom = model->getRom(index);
+    if (rom == NULL)
+        return;
+
+    QPixmap cover = getCover(rom);
+    if (cover.isNull())
+        return;
+
+    QRect coverRect(QPoint(0, 0), cover.size());
+    coverRect.moveCenter(option.rect.center());
+
+    painter->drawPixmap(coverRect.topLeft(), cover);
+}
+
+
+void TableDelegate::requestCover(const QModelIndex &index, CoverLoader::CoverPriority priority) const
+{
+    const Rom *rom = static_cast<const RomTableModel*>(index.model())->getRom(index);
+    if (rom != NULL)
+        getCover(rom, priority);
+}
+
+
+void TableDelegate::updateSettings()
+{
+    imageSize = getImageSize("Table");
+}
@@ -1,5 +1,5 @@
 /***
- * Copyright (c) 2013, Dan Hasting
+ * Copyright (c) 2019, Robert Alm Nilsson
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,43 +29,36 @@
  *
  ***/
 
-#include "clickablewidget.h"
+#ifndef TABLEDELEGATE_H
+#define TABLEDELEGATE_H
 
-#include <QMouseEvent>
+#include "../../roms/coverloader.h"
 
+#include <QPixmap>
+#include <QSize>
+#include <QStyledItemDelegate>
 
-ClickableWidget::ClickableWidget(QWidget *parent) : QWidget(parent)
-{
-    setFocusPolicy(Qt::StrongFocus);
-}
+struct Rom;
 
 
-void ClickableWidget::keyPressEvent(QKeyEvent *event)
+// Paints the cells of the table view.  Text cells are left to
+// QStyledItemDelegate; the Game Cover column draws the scaled cover,
+// which is kept in CoverCache instead of a widget per row.
+class TableDelegate : public QStyledItemDelegate
 {
-    if (event->key() == Qt::Key_Up)
-        emit arrowPressed(this, "UP");
-    else if (event->key() == Qt::Key_Down)
-        emit arrowPressed(this, "DOWN");
-    else if (event->key() == Qt::Key_Left)
-        emit arrowPressed(this, "LEFT");
-    else if (event->key() == Qt::Key_Right)
-        emit arrowPressed(this, "RIGHT");
-    else if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter)
-        emit enterPressed(this);
-    else
-        QWidget::keyPressEvent(event);
-}
+    Q_OBJECT
 
+public:
+    explicit TableDelegate(QObject *parent = 0);
+    void clearCover(const QString &md5);
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    void requestCover(const QModelIndex &index, CoverLoader::CoverPriority priority) const;
+    void updateSettings();
 
-void ClickableWidget::mousePressEvent(QMouseEvent *event)
-{
-    if (event->button() == Qt::LeftButton || event->button() == Qt::RightButton)
-        emit singleClicked(this);
-}
+private:
+    QPixmap getCover(const Rom *rom, CoverLoader::CoverPriority priority = CoverLoader::VisiblePriority) const;
 
+    QSize imageSize;
+};
 
-void ClickableWidget::mouseDoubleClickEvent(QMouseEvent *event)
-{
-    if (event->button() == Qt::LeftButton)
-        emit doubleClicked(this);
-}
+#endif // TABLEDELEGATE_H
@@ -0,0 +1,151 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "facetpanel.h"
+
+#include "../common.h"
+
+#include "../roms/romcollectionmodel.h"
+
+#include <QShowEvent>
+#include <QTimer>
+
+
+FacetPanel::FacetPanel(QWidget *parent) : QTreeWidget(parent)
+{
+    model = NULL;
+
+    setHeaderHidden(true);
+    setRootIsDecorated(true);
+    setStyleSheet("QTreeView { border: none; }");
+    setMaximumWidth(250);
+    setHidden(true);
+
+    //Counts change as pages are read and game info comes in, so refresh at most a few times a second
+    updateTimer = new QTimer(this);
+    updateTimer->setSingleShot(true);
+    updateTimer->setInterval(200);
+
+    connect(updateTimer, SIGNAL(timeout()), this, SLOT(updateFacets()));
+    connect(this, SIGNAL(itemChanged(QTreeWidgetItem*, int)), this, SLOT(updateSelection(QTreeWidgetItem*, int)));
+}
+
+
+void FacetPanel::scheduleUpdate()
+{
+    if (!isHidden())
+        updateTimer->start();
+}
+
+
+void FacetPanel::setModel(RomCollectionModel *model)
+{
+    this->model = model;
+
+    connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(scheduleUpdate()));
+    connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(scheduleUpdate()));
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(scheduleUpdate()));
+    connect(model, SIGNAL(modelReset()), this, SLOT(scheduleUpdate()));
+    connect(model, SIGNAL(filterChanged()), this, SLOT(scheduleUpdate()));
+}
+
+
+void FacetPanel::showEvent(QShowEvent *event)
+{
+    updateFacets();
+
+    QTreeWidget::showEvent(event);
+}
+
+
+void FacetPanel::updateFacets()
+{
+    if (model == NULL)
+        return;
+
+    //Counts are over the whole library, not only the pages read so far
+    model->loadAll();
+
+    //Don't treat rebuilding the check boxes as the user changing the selection
+    blockSignals(true);
+
+    QStringList fields = RomFacetIndex::getFields();
+
+    for (int i = 0; i < fields.size(); i++)
+    {
+        QString field = fields.at(i);
+        QTreeWidgetItem *fieldItem = topLevelItem(i);
+
+        if (fieldItem == NULL) {
+            fieldItem = new QTreeWidgetItem(this);
+            fieldItem->setText(0, getTranslation(field));
+            fieldItem->setData(0, Qt::UserRole, field);
+            fieldItem->setFlags(Qt::ItemIsEnabled);
+        }
+
+        qDeleteAll(fieldItem->takeChildren());
+
+        QMap<QString, int> counts = model->getFacetCounts(field);
+        QStringList selected = model->getFacetFilter(field);
+
+        for (QMap<QString, int>::const_iterator value = counts.constBegin(); value != counts.constEnd(); ++value)
+        {
+            QTreeWidgetItem *valueItem = new QTreeWidgetItem(fieldItem);
+            valueItem->setText(0, value.key() + " (" + QString::number(value.value()) + ")");
+            valueItem->setData(0, Qt::UserRole, value.key());
+            valueItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+            valueItem->setCheckState(0, selected.contains(value.key()) ? Qt::Checked : Qt::Unchecked);
+
+            if (value.value() == 0)
+                valueItem->setForeground(0, QBrush(Qt::gray));
+        }
+
+        fieldItem->setHidden(counts.isEmpty());
+    }
+
+    blockSignals(false);
+}
+
+
+void FacetPanel::updateSelection(QTreeWidgetItem *item, int column)
+{
+    QTreeWidgetItem *fieldItem = item->parent();
+    if (fieldItem == NULL || column != 0)
+        return;
+
+    QStringList values;
+    for (int i = 0; i < fieldItem->childCount(); i++)
+        if (fieldItem->child(i)->checkState(0) == Qt::Checked)
+            values << fieldItem->child(i)->data(0, Qt::UserRole).toString();
+
+    //The model reports back through filterChanged, which refreshes the counts
+    model->setFacetFilter(fieldItem->data(0, Qt::UserRole).toString(), values);
+}
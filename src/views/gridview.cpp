@@ -29,239 +29,320 @@
  *
  ***/
 
+
 #include "gridview.h"
 
 #include "../global.h"
 #include "../common.h"
 
-#include "widgets/clickablewidget.h"
+#include "../roms/coverloader.h"
+#include "../roms/romcollectionmodel.h"
+#include "../roms/romfiltermodel.h"
+
+#include "delegates/griddelegate.h"
 
 #include <QFile>
 #include <QFileInfo>
-#include <QGridLayout>
 #include <QKeyEvent>
-#include <QLabel>
-#include <QScrollArea>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
 #include <QScrollBar>
+#include <QTimer>
 
 
-GridView::GridView(QWidget *parent) : QScrollArea(parent)
-{
-    this->parent = parent;
+// Room the active shadow spreads outside a cell, repainted when the selection moves
+static const int ShadowSpread = 25;
+
 
+GridView::GridView(QWidget *parent) : QAbstractItemView(parent)
+{
     setObjectName("gridView");
     setStyleSheet("#gridView { border: none; }");
-    setBackgroundRole(QPalette::Dark);
-    setAlignment(Qt::AlignHCenter);
+    viewport()->setBackgroundRole(QPalette::Dark);
     setHidden(true);
 
-    setGridBackground();
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setContextMenuPolicy(Qt::CustomContextMenu);
+
+    delegate = new GridDelegate(this);
+    setItemDelegate(delegate);
 
+    //Resizes and row changes come in bursts, lay out once they have all arrived
+    layoutTimer = new QTimer(this);
+    layoutTimer->setSingleShot(true);
+    layoutTimer->setInterval(0);
+    connect(layoutTimer, SIGNAL(timeout()), this, SLOT(updateLayout()));
 
-    gridWidget = new QWidget(this);
-    gridWidget->setObjectName("gridWidget");
-    setWidget(gridWidget);
+    columns = 1;
+    updateGridSize();
 
-    gridLayout = new QGridLayout(gridWidget);
-    gridLayout->setSizeConstraint(QLayout::SetMinAndMaxSize);
-    gridLayout->setRowMinimumHeight(0, 10);
+    setGridBackground();
+    connect(SettingsStore::instance(), SIGNAL(changed()), this, SLOT(setGridBackground()));
+    connect(SettingsStore::instance(), SIGNAL(changed()), this, SLOT(refreshView()));
+
+    savedGridRom = -1;
+    positionx = 0;
+    positiony = 0;
+    lastScrollValue = 0;
+    filterModel = NULL;
 
-    gridWidget->setLayout(gridLayout);
+    connect(CoverLoader::instance(), SIGNAL(coverLoaded(QString)), viewport(), SLOT(update()));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(requestCovers(int)));
 
-    gridCurrent = false;
-    currentGridRom = 0;
+    connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
 }
 
 
-void GridView::addToGridView(Rom *currentRom, int count, bool ddEnabled)
+QRect GridView::getCellRect(int row) const
 {
-    if (ddEnabled) // Add place for "No Cart" entry
-        count++;
+    return QRect(QPoint(row % columns * cellSize.width(), row / columns * cellSize.height()), cellSize);
+}
 
-    ClickableWidget *gameGridItem = new ClickableWidget(gridWidget);
-    gameGridItem->setMinimumWidth(getGridSize("width"));
-    gameGridItem->setMaximumWidth(getGridSize("width"));
-    gameGridItem->setGraphicsEffect(getShadow(false));
-    gameGridItem->setContextMenuPolicy(Qt::CustomContextMenu);
 
-    //Assign ROM data to widget for use in click events
-    gameGridItem->setProperty("fileName", currentRom->fileName);
-    gameGridItem->setProperty("directory", currentRom->directory);
-    if (currentRom->goodName == getTranslation("Unknown ROM") ||
-        currentRom->goodName == getTranslation("Requires catalog file"))
-        gameGridItem->setProperty("search", currentRom->internalName);
+int GridView::getColumnCount()
+{
+    int columnCount;
+    if (CACHED_SETTINGS.gridAutoColumns)
+        columnCount = viewport()->width() / (getGridSize("width") + 10);
     else
-        gameGridItem->setProperty("search", currentRom->goodName);
-    gameGridItem->setProperty("romMD5", currentRom->romMD5);
-    gameGridItem->setProperty("zipFile", currentRom->zipFile);
-
-    QGridLayout *gameGridLayout = new QGridLayout(gameGridItem);
-    gameGridLayout->setColumnStretch(0, 1);
-    gameGridLayout->setColumnStretch(3, 1);
-    gameGridLayout->setRowMinimumHeight(1, getImageSize("Grid").height());
+        columnCount = CACHED_SETTINGS.gridColumnCount;
 
-    QLabel *gridImageLabel = new QLabel(gameGridItem);
-    gridImageLabel->setMinimumHeight(getImageSize("Grid").height());
-    gridImageLabel->setMinimumWidth(getImageSize("Grid").width());
-    QPixmap image;
+    if (columnCount == 0) columnCount = 1;
 
-    if (currentRom->imageExists) {
-        //Use uniform aspect ratio to account for fluctuations in TheGamesDB box art
-        Qt::AspectRatioMode aspectRatioMode = Qt::IgnoreAspectRatio;
+    return columnCount;
+}
 
-        //Don't warp aspect ratio though if image is too far away from standard size (JP box art)
-        float aspectRatio = float(currentRom->image.width()) / currentRom->image.height();
 
-        if (aspectRatio < 1.1 || aspectRatio > 1.8)
-            aspectRatioMode = Qt::KeepAspectRatio;
+QString GridView::getCurrentRomInfo(QString infoName)
+{
+    if (!currentIndex().isValid())
+        return "";
 
-        image = currentRom->image.scaled(getImageSize("Grid"), aspectRatioMode, Qt::SmoothTransformation);
-    } else {
-        if (ddEnabled && count == 0)
-            image = QPixmap(":/images/no-cart.png").scaled(getImageSize("Grid"), Qt::IgnoreAspectRatio,
-                                                             Qt::SmoothTransformation);
-        else
-            image = QPixmap(":/images/not-found.png").scaled(getImageSize("Grid"), Qt::IgnoreAspectRatio,
-                                                             Qt::SmoothTransformation);
-    }
+    return currentIndex().data(RomCollectionModel::getRoleFromName(infoName)).toString();
+}
 
-    gridImageLabel->setPixmap(image);
-    gridImageLabel->setAlignment(Qt::AlignCenter);
-    gameGridLayout->addWidget(gridImageLabel, 1, 1);
 
-    if (SETTINGS.value("Grid/label","true") == "true") {
-        QLabel *gridTextLabel = new QLabel(gameGridItem);
+RomFilterModel *GridView::getFilterModel()
+{
+    return filterModel;
+}
 
-        //Don't allow label to be wider than image
-        gridTextLabel->setMaximumWidth(getImageSize("Grid").width());
 
-        QString text = "";
-        QString labelText = SETTINGS.value("Grid/labeltext","Filename").toString();
+bool GridView::hasSelectedRom()
+{
+    return currentIndex().isValid() && selectionModel()->isSelected(currentIndex());
+}
 
-        text = getRomInfo(labelText, currentRom);
 
-        if (ddEnabled && count == 0)
-            text = tr("No Cart");
+void GridView::highlightGridWidget(const QModelIndex &current, const QModelIndex &previous)
+{
+    //Shadows reach past the cells, so repaint around them as well
+    viewport()->update(visualRect(previous).adjusted(-ShadowSpread, -ShadowSpread, ShadowSpread, ShadowSpread));
+    viewport()->update(visualRect(current).adjusted(-ShadowSpread, -ShadowSpread, ShadowSpread, ShadowSpread));
 
-        gridTextLabel->setText(text);
+    //Clearing the selection on a reset must not look like a game starting
+    if (current.isValid())
+        emit gridItemSelected(true);
+}
 
-        QString textHex = getColor(SETTINGS.value("Grid/labelcolor","White").toString()).name();
-        int fontSize = getGridSize("font");
 
-        gridTextLabel->setStyleSheet("QLabel { font-weight: bold; color: " + textHex + "; font-size: "
-                                     + QString::number(fontSize) + "px; }");
-        gridTextLabel->setWordWrap(true);
-        gridTextLabel->setAlignment(Qt::AlignHCenter | Qt::AlignTop);
+int GridView::horizontalOffset() const
+{
+    return horizontalScrollBar()->value();
+}
 
-        gameGridLayout->addWidget(gridTextLabel, 2, 1);
-    }
 
-    gameGridItem->setLayout(gameGridLayout);
+QModelIndex GridView::indexAt(const QPoint &point) const
+{
+    if (model() == NULL)
+        return QModelIndex();
 
-    gameGridItem->setMinimumHeight(gameGridItem->sizeHint().height());
+    int x = point.x() + horizontalOffset();
+    int y = point.y() + verticalOffset();
+    if (x < 0 || y < 0 || x / cellSize.width() >= columns)
+        return QModelIndex();
 
-    int columnCount;
-    if (SETTINGS.value("Grid/autocolumns","true").toString() == "true")
-        columnCount = viewport()->width() / (getGridSize("width") + 10);
-    else
-        columnCount = SETTINGS.value("Grid/columncount", "4").toInt();
+    int row = y / cellSize.height() * columns + x / cellSize.width();
+    if (row >= model()->rowCount(rootIndex()))
+        return QModelIndex();
 
-    if (columnCount == 0) columnCount = 1;
+    return model()->index(row, 0, rootIndex());
+}
 
-    gridLayout->addWidget(gameGridItem, count / columnCount + 1, count % columnCount + 1);
-    gridWidget->adjustSize();
 
-    connect(gameGridItem, SIGNAL(singleClicked(QWidget*)), this, SLOT(highlightGridWidget(QWidget*)));
-    connect(gameGridItem, SIGNAL(doubleClicked(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
-    connect(gameGridItem, SIGNAL(arrowPressed(QWidget*, QString)), this, SLOT(selectNextRom(QWidget*, QString)));
-    connect(gameGridItem, SIGNAL(enterPressed(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
-    connect(gameGridItem, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
+bool GridView::isIndexHidden(const QModelIndex &) const
+{
+    return false;
 }
 
 
-int GridView::getCurrentRom()
+void GridView::keyPressEvent(QKeyEvent *event)
 {
-    return currentGridRom;
+    if ((event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) && hasSelectedRom())
+        emit enterPressed();
+    else
+        QAbstractItemView::keyPressEvent(event);
 }
 
 
-QString GridView::getCurrentRomInfo(QString infoName)
+QModelIndex GridView::moveCursor(CursorAction cursorAction, Qt::KeyboardModifiers)
 {
-    const char *property = infoName.toUtf8().constData();
+    //Cells are uniform, so the next cell is found from the row number alone instead
+    //of asking the layout which cell lies in that direction
+    if (filterModel == NULL || filterModel->rowCount() == 0)
+        return QModelIndex();
+
+    int count = filterModel->rowCount();
+    int pageRows = qMax(1, viewport()->height() / cellSize.height());
+    int row = currentIndex().isValid() ? currentIndex().row() : -1;
+
+    if (row == -1)
+        return filterModel->index(0, 0);
+
+    switch (cursorAction) {
+    case MoveLeft:
+    case MovePrevious:
+        row = qMax(0, row - 1);
+        break;
+    case MoveRight:
+    case MoveNext:
+        row = qMin(count - 1, row + 1);
+        break;
+    case MoveUp:
+        if (row >= columns)
+            row -= columns;
+        break;
+    case MoveDown:
+        if (row + columns < count)
+            row += columns;
+        else if (row / columns < (count - 1) / columns)
+            row = count - 1;
+        break;
+    case MovePageUp:
+        row = qMax(row % columns, row - pageRows * columns);
+        break;
+    case MovePageDown:
+        row += pageRows * columns;
+        while (row >= count)
+            row -= columns;
+        break;
+    case MoveHome:
+        row = 0;
+        break;
+    case MoveEnd:
+        row = count - 1;
+        break;
+    }
 
-    if (gridLayout->count() > currentGridRom)
-        return gridLayout->itemAt(currentGridRom)->widget()->property(property).toString();
-    return "";
+    return filterModel->index(row, 0);
 }
 
 
-QWidget *GridView::getCurrentRomWidget()
+void GridView::paintEvent(QPaintEvent *event)
 {
-    return gridLayout->itemAt(currentGridRom)->widget();
+    if (model() == NULL)
+        return;
+
+    //Shadows spread into the neighbouring cells, so cells just outside the area paint too
+    QRect area = event->rect().adjusted(-ShadowSpread, -ShadowSpread, ShadowSpread, ShadowSpread)
+                              .translated(horizontalOffset(), verticalOffset());
+
+    int firstLine = qMax(0, area.top() / cellSize.height());
+    int lastLine = area.bottom() / cellSize.height();
+    int firstColumn = qMax(0, area.left() / cellSize.width());
+    int lastColumn = qMin(columns - 1, area.right() / cellSize.width());
+    int count = model()->rowCount(rootIndex());
+
+    QPainter painter(viewport());
+    QStyleOptionViewItem option = viewOptions();
+    QStyle::State state = option.state;
+
+    for (int line = firstLine; line <= lastLine; line++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            int row = line * columns + column;
+            if (row >= count)
+                return;
+
+            QModelIndex index = model()->index(row, 0, rootIndex());
+            option.rect = visualRect(index);
+            option.state = state;
+
+            if (selectionModel()->isSelected(index))
+                option.state |= QStyle::State_Selected;
+            if (index == currentIndex() && hasFocus())
+                option.state |= QStyle::State_HasFocus;
+
+            delegate->paint(&painter, option, index);
+        }
+    }
 }
 
 
-bool GridView::hasSelectedRom()
+void GridView::refreshView()
 {
-    return gridCurrent;
+    delegate->updateSettings();
+    updateLayout();
 }
 
 
-void GridView::highlightGridWidget(QWidget *current)
+void GridView::requestCovers(int value)
 {
-    current->setFocus();
-
-    //Set all to inactive shadow
-    QLayoutItem *gridItem;
-    for (int item = 0; (gridItem = gridLayout->itemAt(item)) != NULL; item++)
-    {
-        gridItem->widget()->setGraphicsEffect(getShadow(false));
-
-        if (gridItem->widget() == current)
-            currentGridRom = item;
+    if (filterModel == NULL)
+        return;
+
+    int rowHeight = cellSize.height();
+    int pageCount = (viewport()->height() / rowHeight + 1) * columns;
+    int first = value / rowHeight * columns;
+    bool down = value >= lastScrollValue;
+    lastScrollValue = value;
+
+    //Covers on screen first, then the next screenful in the direction of scrolling,
+    //nearest first.  The loader forgets any other cover it has not started on yet.
+    CoverLoader::instance()->beginRequests();
+
+    int count = filterModel->rowCount();
+    for (int row = first; row < qMin(first + pageCount, count); row++)
+        delegate->requestCover(filterModel->index(row, 0), CoverLoader::VisiblePriority);
+
+    if (down) {
+        for (int row = first + pageCount; row < qMin(first + pageCount * 2, count); row++)
+            delegate->requestCover(filterModel->index(row, 0), CoverLoader::PrefetchPriority);
+    } else {
+        for (int row = first - 1; row >= qMax(0, first - pageCount); row--)
+            delegate->requestCover(filterModel->index(row, 0), CoverLoader::PrefetchPriority);
     }
 
-    //Set current to active shadow
-    current->setGraphicsEffect(getShadow(true));
-
-    gridCurrent = true;
-    emit gridItemSelected(true);
+    CoverLoader::instance()->endRequests();
 }
 
 
-void GridView::keyPressEvent(QKeyEvent *event)
+void GridView::releaseView()
 {
-    if ((event->key() == Qt::Key_Down || event->key() == Qt::Key_Right) && gridLayout->count() > 0) {
-        highlightGridWidget(gridLayout->itemAt(0)->widget());
-        ensureWidgetVisible(gridLayout->itemAt(0)->widget());
-    } else
-        QScrollArea::keyPressEvent(event);
+    //Let go of the background image, the style sheet is what holds on to it
+    setStyleSheet("#gridView { border: none; }");
 }
 
 
 void GridView::resetView()
 {
-    QLayoutItem *gridItem;
-    while ((gridItem = gridLayout->takeAt(0)) != NULL)
-    {
-        delete gridItem->widget();
-        delete gridItem;
-    }
-
-    gridCurrent = false;
+    if (selectionModel() != NULL)
+        selectionModel()->clear();
 }
 
 
 void GridView::resizeEvent(QResizeEvent *event)
 {
-    int check = event->size().width() / (getGridSize("width") + 10);
-    bool autoAdjustColumns = SETTINGS.value("Grid/autocolumns","true").toString() == "true";
+    QAbstractItemView::resizeEvent(event);
+    layoutTimer->start();
+}
+
 
-    if (autoAdjustColumns && check != autoColumnCount && check != 0) {
-        autoColumnCount = check;
-        updateGridColumns(event->size().width());
-    } else
-        QScrollArea::resizeEvent(event);
+void GridView::restoreView()
+{
+    setGridBackground();
+    if (isVisible())
+        requestCovers(verticalScrollBar()->value());
 }
 
 
@@ -270,54 +351,78 @@ void GridView::saveGridPosition()
     positionx = horizontalScrollBar()->value();
     positiony = verticalScrollBar()->value();
 
-    if (gridCurrent)
-        savedGridRom = currentGridRom;
+    if (hasSelectedRom())
+        savedGridRom = currentIndex().row();
     else
         savedGridRom = -1;
     savedGridRomFilename = getCurrentRomInfo("fileName");
 }
 
 
-void GridView::selectNextRom(QWidget* current, QString keypress)
+void GridView::scrollTo(const QModelIndex &index, ScrollHint hint)
 {
-    int columnCount;
-    if (SETTINGS.value("Grid/autocolumns","true").toString() == "true")
-        columnCount = autoColumnCount;
-    else
-        columnCount = SETTINGS.value("Grid/columncount", "4").toInt();
-
-    int offset = 0;
-    if (keypress == "UP")
-        offset = columnCount * -1;
-    else if (keypress == "DOWN")
-        offset = columnCount;
-    else if (keypress == "RIGHT")
-        offset = 1;
-    else if (keypress == "LEFT")
-        offset = -1;
-
-    QLayoutItem *gridItem;
-    for (int item = 0; (gridItem = gridLayout->itemAt(item)) != NULL; item++)
-    {
-        if (gridItem->widget() == current && item + offset >= 0 && gridLayout->itemAt(item + offset) != NULL) {
-            ensureWidgetVisible(gridLayout->itemAt(item + offset)->widget());
-            highlightGridWidget(gridLayout->itemAt(item + offset)->widget());
-        }
+    QRect rect = visualRect(index);
+    QRect area = viewport()->rect();
+    if (!rect.isValid())
+        return;
+
+    int dy = 0;
+    switch (hint) {
+    case PositionAtTop:
+        dy = rect.top();
+        break;
+    case PositionAtBottom:
+        dy = rect.bottom() - area.bottom();
+        break;
+    case PositionAtCenter:
+        dy = rect.center().y() - area.center().y();
+        break;
+    case EnsureVisible:
+        if (rect.top() < 0)
+            dy = rect.top();
+        else if (rect.bottom() > area.bottom())
+            dy = qMin(rect.bottom() - area.bottom(), rect.top());
+        break;
     }
+
+    int dx = 0;
+    if (rect.left() < 0)
+        dx = rect.left();
+    else if (rect.right() > area.right())
+        dx = qMin(rect.right() - area.right(), rect.left());
+
+    verticalScrollBar()->setValue(verticalScrollBar()->value() + dy);
+    horizontalScrollBar()->setValue(horizontalScrollBar()->value() + dx);
+}
+
+
+void GridView::setCollectionModel(RomCollectionModel *model)
+{
+    filterModel = new RomFilterModel(model, this);
+    QAbstractItemView::setModel(filterModel);
+
+    connect(filterModel, SIGNAL(rowsInserted(QModelIndex, int, int)), layoutTimer, SLOT(start()));
+    connect(filterModel, SIGNAL(rowsRemoved(QModelIndex, int, int)), layoutTimer, SLOT(start()));
+    connect(filterModel, SIGNAL(modelReset()), layoutTimer, SLOT(start()));
+    connect(filterModel, SIGNAL(layoutChanged()), layoutTimer, SLOT(start()));
+
+    connect(selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)),
+            this, SLOT(highlightGridWidget(QModelIndex, QModelIndex)));
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(updateRows(QModelIndex, QModelIndex)));
 }
 
 
 void GridView::setGridBackground()
 {
-    QString theme = SETTINGS.value("Grid/theme", "Normal").toString();
+    QString theme = CACHED_SETTINGS.gridTheme;
     if (theme == "Light")
-        setStyleSheet("#gridView { border: none; background: #FFF; } #gridWidget { background: transparent; }");
+        setStyleSheet("#gridView { border: none; background: #FFF; }");
     else if (theme == "Dark")
-        setStyleSheet("#gridView { border: none; background: #222; } #gridWidget { background: transparent; }");
+        setStyleSheet("#gridView { border: none; background: #222; }");
     else
         setStyleSheet("#gridView { border: none; }");
 
-    QString background = SETTINGS.value("Grid/background", "").toString();
+    QString background = CACHED_SETTINGS.gridBackground;
     if (background != "") {
         QFile backgroundFile(background);
 
@@ -328,7 +433,7 @@ void GridView::setGridBackground()
                     + "background: url(" + background + "); "
                     + "background-attachment: fixed; "
                     + "background-position: top center; "
-                + "} #gridWidget { background: transparent; } "
+                + "}"
             );
     }
 }
@@ -336,39 +441,122 @@ void GridView::setGridBackground()
 
 void GridView::setGridPosition()
 {
+    //The scroll ranges have to be up to date before the position is restored
+    updateLayout();
+
     horizontalScrollBar()->setValue(positionx);
     verticalScrollBar()->setValue(positiony);
 
     //Restore selected ROM if it is in the same position
-    if (savedGridRom != -1 && gridLayout->count() > savedGridRom) {
-        QWidget *checkWidget = gridLayout->itemAt(savedGridRom)->widget();
-        if (checkWidget->property("fileName").toString() == savedGridRomFilename)
-            highlightGridWidget(checkWidget);
+    if (savedGridRom != -1 && filterModel != NULL && filterModel->rowCount() > savedGridRom) {
+        QModelIndex checkIndex = filterModel->index(savedGridRom, 0);
+        if (checkIndex.data(RomCollectionModel::FileNameRole).toString() == savedGridRomFilename)
+            setCurrentIndex(checkIndex);
     }
 
-    if (SETTINGS.value("Grid/autocolumns","true").toString() == "true")
+    if (CACHED_SETTINGS.gridAutoColumns)
         setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     else
         setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
 }
 
 
-void GridView::updateGridColumns(int width)
+void GridView::setSelection(const QRect &rect, QItemSelectionModel::SelectionFlags command)
 {
-    int columnCount = width / (getGridSize("width") + 10);
+    if (model() == NULL)
+        return;
+
+    //Every cell the rectangle touches, which is a single one for a click
+    QRect area = rect.normalized().translated(horizontalOffset(), verticalOffset());
+
+    int firstLine = qMax(0, area.top() / cellSize.height());
+    int lastLine = area.bottom() / cellSize.height();
+    int firstColumn = qMax(0, area.left() / cellSize.width());
+    int lastColumn = qMin(columns - 1, area.right() / cellSize.width());
+    int count = model()->rowCount(rootIndex());
 
-    int gridCount = gridLayout->count();
-    QList<QWidget*> gridItems;
-    for (int count = 0; count < gridCount; count++)
-        gridItems << gridLayout->takeAt(0)->widget();
+    QItemSelection selection;
+    for (int line = firstLine; line <= lastLine && firstColumn <= lastColumn; line++) {
+        int first = line * columns + firstColumn;
+        int last = qMin(line * columns + lastColumn, count - 1);
 
-    int count = 0;
-    foreach(QWidget *gridItem, gridItems)
-    {
-        gridLayout->addWidget(gridItem, count / columnCount + 1, count % columnCount + 1);
-        count++;
+        if (first <= last)
+            selection.select(model()->index(first, 0, rootIndex()), model()->index(last, 0, rootIndex()));
     }
 
-    gridWidget->adjustSize();
+    selectionModel()->select(selection, command);
 }
 
+
+void GridView::updateGeometries()
+{
+    int count = model() != NULL ? model()->rowCount(rootIndex()) : 0;
+    int lines = (count + columns - 1) / columns;
+
+    verticalScrollBar()->setSingleStep(cellSize.height() / 4);
+    verticalScrollBar()->setPageStep(viewport()->height());
+    verticalScrollBar()->setRange(0, qMax(0, lines * cellSize.height() - viewport()->height()));
+
+    horizontalScrollBar()->setSingleStep(cellSize.width() / 4);
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, qMax(0, columns * cellSize.width() - viewport()->width()));
+
+    QAbstractItemView::updateGeometries();
+}
+
+
+void GridView::updateGridSize()
+{
+    //Spread the columns over the whole width like the stretched layout columns did
+    columns = getColumnCount();
+    int cellWidth = getGridSize("width") + 10;
+    int width = qMax(cellWidth, (viewport()->width() - 1) / columns);
+
+    cellSize = QSize(width, getGridSize("height") + 10);
+}
+
+
+void GridView::updateLayout()
+{
+    layoutTimer->stop();
+
+    updateGridSize();
+    updateGeometries();
+    viewport()->update();
+}
+
+
+void GridView::updateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    //Covers are cached scaled, so drop the ones that may have been replaced
+    RomCollectionModel *model = filterModel->getSourceModel();
+    for (int row = topLeft.row(); row <= bottomRight.row(); row++)
+        delegate->clearCover(model->index(row).data(RomCollectionModel::MD5Role).toString());
+}
+
+
+int GridView::verticalOffset() const
+{
+    return verticalScrollBar()->value();
+}
+
+
+QRect GridView::visualRect(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return QRect();
+
+    return getCellRect(index.row()).translated(-horizontalOffset(), -verticalOffset());
+}
+
+
+QRegion GridView::visualRegionForSelection(const QItemSelection &selection) const
+{
+    QRegion region;
+
+    foreach (const QItemSelectionRange &range, selection)
+        for (int row = range.top(); row <= range.bottom(); row++)
+            region += visualRect(model()->index(row, 0, rootIndex()));
+
+    return region;
+}
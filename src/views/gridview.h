@@ -29,56 +29,86 @@
  *
  ***/
 
+
 #ifndef GRIDVIEW_H
 #define GRIDVIEW_H
 
-#include <QScrollArea>
+#include <QAbstractItemView>
+#include <QModelIndex>
 
-class QGridLayout;
-struct Rom;
+class GridDelegate;
+class QTimer;
+class RomCollectionModel;
+class RomFilterModel;
 
 
-class GridView : public QScrollArea
+// Cover grid over the collection model.  Cells are all the same size and
+// laid out row by row, so where a cell is follows from its row number
+// alone: resizing only recomputes the cell size and column count, and
+// only the cells on screen are painted, by GridDelegate.  Nothing in the
+// view grows with the number of ROMs.
+class GridView : public QAbstractItemView
 {
     Q_OBJECT
 
 public:
     explicit GridView(QWidget *parent = 0);
-    void addToGridView(Rom *currentRom, int count, bool ddEnabled);
-    int getCurrentRom();
     QString getCurrentRomInfo(QString infoName);
-    QWidget *getCurrentRomWidget();
+    RomFilterModel *getFilterModel();
     bool hasSelectedRom();
+    QModelIndex indexAt(const QPoint &point) const;
+    void releaseView();
     void resetView();
+    void restoreView();
     void saveGridPosition();
+    void scrollTo(const QModelIndex &index, ScrollHint hint = EnsureVisible);
+    void setCollectionModel(RomCollectionModel *model);
+    QRect visualRect(const QModelIndex &index) const;
+
+public slots:
+    void refreshView();
     void setGridBackground();
 
 protected:
+    int horizontalOffset() const;
+    bool isIndexHidden(const QModelIndex &index) const;
     void keyPressEvent(QKeyEvent *event);
+    QModelIndex moveCursor(CursorAction cursorAction, Qt::KeyboardModifiers modifiers);
+    void paintEvent(QPaintEvent *event);
     void resizeEvent(QResizeEvent *event);
+    void setSelection(const QRect &rect, QItemSelectionModel::SelectionFlags command);
+    void updateGeometries();
+    int verticalOffset() const;
+    QRegion visualRegionForSelection(const QItemSelection &selection) const;
 
 signals:
+    void enterPressed();
     void gridItemSelected(bool active);
 
 private:
-    void updateGridColumns(int width);
+    QRect getCellRect(int row) const;
+    int getColumnCount();
+    void updateGridSize();
+
+    int columns;
+    QSize cellSize;
 
-    int autoColumnCount;
-    int currentGridRom;
-    bool gridCurrent;
     int savedGridRom;
     QString savedGridRomFilename;
     int positionx;
     int positiony;
+    int lastScrollValue;
 
-    QGridLayout *gridLayout;
-    QWidget *gridWidget;
-    QWidget *parent;
+    GridDelegate *delegate;
+    RomFilterModel *filterModel;
+    QTimer *layoutTimer;
 
 private slots:
-    void highlightGridWidget(QWidget *current);
-    void selectNextRom(QWidget *current, QString keypress);
+    void highlightGridWidget(const QModelIndex &current, const QModelIndex &previous);
+    void requestCovers(int value);
     void setGridPosition();
+    void updateLayout();
+    void updateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight);
 };
 
 #endif // GRIDVIEW_H
@@ -29,250 +29,168 @@
  *
  ***/
 
+
 #include "listview.h"
 
 #include "../global.h"
 #include "../common.h"
 
-#include "widgets/clickablewidget.h"
+#include "../roms/coverloader.h"
+#include "../roms/romcollectionmodel.h"
+#include "../roms/romfiltermodel.h"
+
+#include "delegates/listdelegate.h"
 
-#include <QFile>
-#include <QFileInfo>
-#include <QGridLayout>
 #include <QKeyEvent>
-#include <QLabel>
-#include <QScrollArea>
+#include <QResizeEvent>
 #include <QScrollBar>
-#include <QTimer>
 
 
-ListView::ListView(QWidget *parent) : QScrollArea(parent)
-{
-    this->parent = parent;
+// Rows measured per layout pass, rows have their own heights so a large list is laid out in steps
+static const int LayoutBatchSize = 200;
+
 
+ListView::ListView(QWidget *parent) : QListView(parent)
+{
     setObjectName("listView");
-    setWidgetResizable(true);
     setHidden(true);
 
-    setListBackground();
+    setViewMode(QListView::ListMode);
+    setMovement(QListView::Static);
+    setResizeMode(QListView::Adjust);
+    setLayoutMode(QListView::Batched);
+    setBatchSize(LayoutBatchSize);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setContextMenuPolicy(Qt::CustomContextMenu);
 
+    delegate = new ListDelegate(this);
+    setItemDelegate(delegate);
+
+    setListBackground();
+    connect(SettingsStore::instance(), SIGNAL(changed()), this, SLOT(setListBackground()));
+    connect(SettingsStore::instance(), SIGNAL(changed()), this, SLOT(refreshView()));
 
-    listWidget = new QWidget(this);
-    listWidget->setObjectName("listWidget");
-    setWidget(listWidget);
+    savedListRom = -1;
+    positionx = 0;
+    positiony = 0;
+    lastScrollValue = 0;
+    filterModel = NULL;
 
-    listLayout = new QVBoxLayout(listWidget);
-    listLayout->setSizeConstraint(QLayout::SetMinAndMaxSize);
-    listWidget->setLayout(listLayout);
+    connect(CoverLoader::instance(), SIGNAL(coverLoaded(QString)), viewport(), SLOT(update()));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(requestCovers(int)));
 
-    listCurrent = false;
-    currentListRom = 0;
+    connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
 }
 
 
-void ListView::addToListView(Rom *currentRom, int count, bool ddEnabled)
+QString ListView::getCurrentRomInfo(QString infoName)
 {
-    if (ddEnabled) // Add place for "No Cart" entry
-        count++;
-
-    QStringList visible = SETTINGS.value("List/columns", "Filename|Internal Name|Size").toString().split("|");
-
-    if (visible.join("") == "" && SETTINGS.value("List/displaycover", "") != "true")
-        //Otherwise no columns, so don't bother populating
-        return;
-
-    ClickableWidget *gameListItem = new ClickableWidget(listWidget);
-    gameListItem->setContentsMargins(0, 0, 20, 0);
-    gameListItem->setContextMenuPolicy(Qt::CustomContextMenu);
-    if (SETTINGS.value("theme", "Default").toString() == "Dark") {
-        gameListItem->setStyleSheet("color:#EEE;");
-    }
-
-    //Assign ROM data to widget for use in click events
-    gameListItem->setProperty("fileName", currentRom->fileName);
-    gameListItem->setProperty("directory", currentRom->directory);
-    if (currentRom->goodName == getTranslation("Unknown ROM") ||
-        currentRom->goodName == getTranslation("Requires catalog file"))
-        gameListItem->setProperty("search", currentRom->internalName);
-    else
-        gameListItem->setProperty("search", currentRom->goodName);
-    gameListItem->setProperty("romMD5", currentRom->romMD5);
-    gameListItem->setProperty("zipFile", currentRom->zipFile);
-
-    QGridLayout *gameListLayout = new QGridLayout(gameListItem);
-    gameListLayout->setColumnStretch(3, 1);
-
-    //Add image
-    if (SETTINGS.value("List/displaycover", "") == "true") {
-        QLabel *listImageLabel = new QLabel(gameListItem);
-        listImageLabel->setMinimumHeight(getImageSize("List").height());
-        listImageLabel->setMinimumWidth(getImageSize("List").width());
-
-        QPixmap image;
-
-        if (currentRom->imageExists)
-            image = currentRom->image.scaled(getImageSize("List"), Qt::KeepAspectRatio,
-                                            Qt::SmoothTransformation);
-        else {
-            if (ddEnabled && count == 0)
-                image = QPixmap(":/images/no-cart.png").scaled(getImageSize("List"), Qt::KeepAspectRatio,
-                                                                 Qt::SmoothTransformation);
-            else
-                image = QPixmap(":/images/not-found.png").scaled(getImageSize("List"), Qt::KeepAspectRatio,
-                                                                 Qt::SmoothTransformation);
-        }
-
-        listImageLabel->setPixmap(image);
-        listImageLabel->setAlignment(Qt::AlignCenter);
-        gameListLayout->addWidget(listImageLabel, 0, 1);
-    }
-
-    //Create text label
-    QLabel *listTextLabel = new QLabel("", gameListItem);
-    QString listText = "";
-
-    int i = 0;
-
-    foreach (QString current, visible)
-    {
-        QString addition = "";
-
-        if (i == 0 && SETTINGS.value("List/firstitemheader","true") == "true")
-            addition += "<h2 style='line-height:120%;margin:0;padding:0;'>";
-        else
-            addition += "<div style='line-height:120%;margin:0;padding:0;'><b>" + current + ":</b> ";
-
-        addition += getRomInfo(current, currentRom, true);
-
-        if (i == 0 && SETTINGS.value("List/firstitemheader","true") == "true")
-            addition += "</h2>";
-        else
-            addition += "</div>";
-
-        if (addition.right(12) != ":</b> </div>")
-            listText += addition;
-
-        i++;
-    }
-
-    if (ddEnabled && count == 0)
-        listText = "<h2>" + tr("No Cart") + "</h2>";
-
-    listTextLabel->setText(listText);
-    listTextLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-    listTextLabel->setWordWrap(true);
-    QFont font = listTextLabel->font();
-    font.setPointSize(getTextSize());
-    listTextLabel->setFont(font);
-    gameListLayout->addWidget(listTextLabel, 0, 3);
-
-    gameListLayout->setColumnMinimumWidth(0, 20);
-    gameListLayout->setColumnMinimumWidth(2, 10);
-    gameListItem->setLayout(gameListLayout);
-
-    if (count != 0) {
-        QFrame *separator = new QFrame();
-        separator->setFrameShape(QFrame::HLine);
-        separator->setStyleSheet("margin:0;padding:0;");
-        QPalette palette = separator->palette();
-        if (SETTINGS.value("theme", "Default").toString() == "Dark") {
-            palette.setColor(QPalette::Window, Qt::black);
-        } else {
-            palette.setColor(QPalette::Window, Qt::gray);
-        }
-        separator->setPalette(palette);
-        listLayout->addWidget(separator);
-    }
-
-    listLayout->addWidget(gameListItem);
+    if (!currentIndex().isValid())
+        return "";
 
-    connect(gameListItem, SIGNAL(singleClicked(QWidget*)), this, SLOT(highlightListWidget(QWidget*)));
-    connect(gameListItem, SIGNAL(doubleClicked(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
-    connect(gameListItem, SIGNAL(arrowPressed(QWidget*, QString)), this, SLOT(selectNextRom(QWidget*, QString)));
-    connect(gameListItem, SIGNAL(enterPressed(QWidget*)), parent, SLOT(launchRomFromWidget(QWidget*)));
-    connect(gameListItem, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
+    return currentIndex().data(RomCollectionModel::getRoleFromName(infoName)).toString();
 }
 
 
-int ListView::getCurrentRom()
+RomFilterModel *ListView::getFilterModel()
 {
-    return currentListRom;
+    return filterModel;
 }
 
 
-QString ListView::getCurrentRomInfo(QString infoName)
+bool ListView::hasSelectedRom()
 {
-    const char *property = infoName.toUtf8().constData();
-
-    if (listLayout->count() > currentListRom)
-        return listLayout->itemAt(currentListRom)->widget()->property(property).toString();
-    return "";
+    return currentIndex().isValid() && selectionModel()->isSelected(currentIndex());
 }
 
 
-QWidget *ListView::getCurrentRomWidget()
+void ListView::highlightListWidget(const QModelIndex &current)
 {
-    return listLayout->itemAt(currentListRom)->widget();
+    //Clearing the selection on a reset must not look like a game starting
+    if (current.isValid())
+        emit listItemSelected(true);
 }
 
 
-bool ListView::hasSelectedRom()
+void ListView::keyPressEvent(QKeyEvent *event)
 {
-    return listCurrent;
+    if ((event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) && hasSelectedRom())
+        emit enterPressed();
+    else
+        QListView::keyPressEvent(event);
 }
 
 
-void ListView::highlightListWidget(QWidget *current)
+void ListView::requestCovers(int value)
 {
-    current->setFocus();
+    QModelIndex firstIndex = indexAt(QPoint(1, 1));
+    if (filterModel == NULL || !firstIndex.isValid())
+        return;
 
-    QLayoutItem *listItem;
-    for (int item = 0; (listItem = listLayout->itemAt(item)) != NULL; item++)
-    {
-        if (listItem->widget() == current)
-            currentListRom = item;
-    }
+    QModelIndex last = indexAt(QPoint(1, viewport()->height() - 1));
+    int first = firstIndex.row();
+    int pageCount = (last.isValid() ? last.row() : filterModel->rowCount() - 1) - first + 1;
+    bool down = value >= lastScrollValue;
+    lastScrollValue = value;
 
-    //Give current left margin to stand out
-    //Delay with QTimer so right-click menu appears correctly
-    QTimer::singleShot(5, this, SLOT(highlightListWidgetSetMargin()));
+    //Same order as the grid: rows on screen, then the rows scrolled towards
+    CoverLoader::instance()->beginRequests();
 
-    listCurrent = true;
-    emit listItemSelected(true);
+    int count = filterModel->rowCount();
+    for (int row = first; row < qMin(first + pageCount, count); row++)
+        delegate->requestCover(filterModel->index(row, 0), CoverLoader::VisiblePriority);
+
+    if (down) {
+        for (int row = first + pageCount; row < qMin(first + pageCount * 2, count); row++)
+            delegate->requestCover(filterModel->index(row, 0), CoverLoader::PrefetchPriority);
+    } else {
+        for (int row = first - 1; row >= qMax(0, first - pageCount); row--)
+            delegate->requestCover(filterModel->index(row, 0), CoverLoader::PrefetchPriority);
+    }
+
+    CoverLoader::instance()->endRequests();
 }
 
 
-void ListView::highlightListWidgetSetMargin()
+void ListView::refreshView()
 {
-    //Reset all margins
-    QLayoutItem *listItem;
-    for (int item = 0; (listItem = listLayout->itemAt(item)) != NULL; item++)
-        listItem->widget()->setContentsMargins(0, 0, 20, 0);
-
-    getCurrentRomWidget()->setContentsMargins(20, 0, 0, 0);
+    delegate->updateSettings();
+    delegate->setRowWidth(viewport()->width());
+    doItemsLayout();
 }
 
 
-void ListView::keyPressEvent(QKeyEvent *event)
+void ListView::releaseView()
 {
-    if (event->key() == Qt::Key_Down && listLayout->count() > 0) {
-        highlightListWidget(listLayout->itemAt(0)->widget());
-        ensureWidgetVisible(listLayout->itemAt(0)->widget());
-    } else
-        QScrollArea::keyPressEvent(event);
+    delegate->clearRows();
 }
 
 
 void ListView::resetView()
 {
-    QLayoutItem *listItem;
-    while ((listItem = listLayout->takeAt(0)) != NULL)
-    {
-        delete listItem->widget();
-        delete listItem;
+    if (selectionModel() != NULL)
+        selectionModel()->clear();
+}
+
+
+void ListView::resizeEvent(QResizeEvent *event)
+{
+    //Row height depends on how the text wraps at the new width
+    if (event->size().width() != event->oldSize().width()) {
+        delegate->setRowWidth(viewport()->width());
+        scheduleDelayedItemsLayout();
     }
 
-    listCurrent = false;
+    QListView::resizeEvent(event);
+}
+
+
+void ListView::restoreView()
+{
+    if (isVisible())
+        requestCovers(verticalScrollBar()->value());
 }
 
 
@@ -281,39 +199,31 @@ void ListView::saveListPosition()
     positionx = horizontalScrollBar()->value();
     positiony = verticalScrollBar()->value();
 
-    if (listCurrent)
-        savedListRom = currentListRom;
+    if (hasSelectedRom())
+        savedListRom = currentIndex().row();
     else
         savedListRom = -1;
     savedListRomFilename = getCurrentRomInfo("fileName");
 }
 
 
-void ListView::selectNextRom(QWidget* current, QString keypress)
+void ListView::setCollectionModel(RomCollectionModel *model)
 {
-    int offset = 0;
-    if (keypress == "UP" || keypress == "LEFT")
-        offset = -2;
-    else if (keypress == "DOWN" || keypress == "RIGHT")
-        offset = 2;
-
-    QLayoutItem *listItem;
-    for (int item = 0; (listItem = listLayout->itemAt(item)) != NULL; item++)
-    {
-        if (listItem->widget() == current && item + offset >= 0 && listLayout->itemAt(item + offset) != NULL) {
-            ensureWidgetVisible(listLayout->itemAt(item + offset)->widget());
-            highlightListWidget(listLayout->itemAt(item + offset)->widget());
-        }
-    }
+    filterModel = new RomFilterModel(model, this);
+    QListView::setModel(filterModel);
+
+    connect(selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)),
+            this, SLOT(highlightListWidget(QModelIndex)));
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(updateRows(QModelIndex, QModelIndex)));
 }
 
 
 void ListView::setListBackground()
 {
-    if (SETTINGS.value("theme", "Default").toString() == "Dark") {
-        setStyleSheet("#listView { border: none; background: #222; } #listWidget { background: transparent; }");
+    if (CACHED_SETTINGS.theme == "Dark") {
+        setStyleSheet("#listView { border: none; background: #222; }");
     } else {
-        setStyleSheet("#listView { border: none; background: #FFF; } #listWidget { background: transparent; }");
+        setStyleSheet("#listView { border: none; background: #FFF; }");
     }
 }
 
@@ -324,9 +234,21 @@ void ListView::setListPosition()
     verticalScrollBar()->setValue(positiony);
 
     //Restore selected ROM if it is in the same position
-    if (savedListRom != -1 && listLayout->count() > savedListRom) {
-        QWidget *checkWidget = listLayout->itemAt(savedListRom)->widget();
-        if (checkWidget->property("fileName").toString() == savedListRomFilename)
-            highlightListWidget(checkWidget);
+    if (savedListRom != -1 && filterModel != NULL && filterModel->rowCount() > savedListRom) {
+        QModelIndex checkIndex = filterModel->index(savedListRom, 0);
+        if (checkIndex.data(RomCollectionModel::FileNameRole).toString() == savedListRomFilename)
+            setCurrentIndex(checkIndex);
     }
 }
+
+
+void ListView::updateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    //Text and covers are cached per ROM, so drop the ones that changed
+    RomCollectionModel *model = filterModel->getSourceModel();
+    for (int row = topLeft.row(); row <= bottomRight.row(); row++)
+        delegate->clearRow(model->index(row).data(RomCollectionModel::MD5Role).toString());
+
+    //The new text may wrap to a different height
+    scheduleDelayedItemsLayout();
+}
@@ -29,53 +29,63 @@
  *
  ***/
 
+
 #ifndef LISTVIEW_H
 #define LISTVIEW_H
 
-#include <QScrollArea>
+#include <QListView>
+#include <QModelIndex>
 
-class QVBoxLayout;
-struct Rom;
+class ListDelegate;
+class RomCollectionModel;
+class RomFilterModel;
 
 
-class ListView : public QScrollArea
+// List of the collection with a cover and the chosen fields on every
+// row.  Rows are painted by ListDelegate and only the ones on screen
+// are laid out, so large collections cost no more than small ones.
+class ListView : public QListView
 {
     Q_OBJECT
 
 public:
     explicit ListView(QWidget *parent = 0);
-    void addToListView(Rom *currentRom, int count, bool ddEnabled);
-    int getCurrentRom();
     QString getCurrentRomInfo(QString infoName);
-    QWidget *getCurrentRomWidget();
+    RomFilterModel *getFilterModel();
     bool hasSelectedRom();
+    void releaseView();
     void resetView();
+    void restoreView();
     void saveListPosition();
+    void setCollectionModel(RomCollectionModel *model);
+
+public slots:
+    void refreshView();
     void setListBackground();
 
 protected:
     void keyPressEvent(QKeyEvent *event);
+    void resizeEvent(QResizeEvent *event);
 
 signals:
+    void enterPressed();
     void listItemSelected(bool active);
 
 private:
-    int currentListRom;
-    bool listCurrent;
     int savedListRom;
     QString savedListRomFilename;
     int positionx;
     int positiony;
+    int lastScrollValue;
 
-    QVBoxLayout *listLayout;
-    QWidget *listWidget;
-    QWidget *parent;
+    ListDelegate *delegate;
+    RomFilterModel *filterModel;
 
 private slots:
-    void highlightListWidget(QWidget *current);
-    void highlightListWidgetSetMargin();
-    void selectNextRom(QWidget *current, QString keypress);
+    void highlightListWidget(const QModelIndex &current);
+    void requestCovers(int value);
     void setListPosition();
+    void updateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight);
 
 };
 
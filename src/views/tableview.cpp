@@ -29,30 +29,31 @@
  *
  ***/
 
+
 #include "tableview.h"
 
 #include "../global.h"
 #include "../common.h"
 
-#include "widgets/treewidgetitem.h"
+#include "../roms/coverloader.h"
+#include "../roms/romcollectionmodel.h"
+#include "../roms/romfiltermodel.h"
+#include "../roms/romtablemodel.h"
+
+#include "delegates/tabledelegate.h"
 
-#include <QFile>
-#include <QFileInfo>
-#include <QGridLayout>
 #include <QHeaderView>
 #include <QKeyEvent>
-#include <QLabel>
 #include <QScrollBar>
 
 
-TableView::TableView(QWidget *parent) : QTreeWidget(parent)
+TableView::TableView(QWidget *parent) : QTreeView(parent)
 {
-    this->parent = parent;
-
     setWordWrap(false);
     setAllColumnsShowFocus(true);
     setRootIsDecorated(false);
-    setSortingEnabled(true);
+    setUniformRowHeights(true);
+    setSelectionBehavior(QAbstractItemView::SelectRows);
     setContextMenuPolicy(Qt::CustomContextMenu);
     setStyleSheet("QTreeView { border: none; } QTreeView::item { height: 25px; }");
 
@@ -60,183 +61,120 @@ TableView::TableView(QWidget *parent) : QTreeWidget(parent)
     setHeader(headerView);
     setHidden(true);
 
-    connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
-    connect(headerView, SIGNAL(sortIndicatorChanged(int,Qt::SortOrder)),
-            this, SLOT(saveSortOrder(int,Qt::SortOrder)));
-}
-
+    delegate = new TableDelegate(this);
+    setItemDelegate(delegate);
 
-void TableView::addNoCartRow()
-{
-    QStringList visible = SETTINGS.value("Table/columns", "Filename|Size").toString().split("|");
+    savedTableRom = -1;
+    positionx = 0;
+    positiony = 0;
+    lastScrollValue = 0;
+    model = NULL;
+    filterModel = NULL;
+    tableModel = NULL;
 
-    fileItem = new TreeWidgetItem(this);
+    connect(CoverLoader::instance(), SIGNAL(coverLoaded(QString)), viewport(), SLOT(update()));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(requestCovers(int)));
 
-    if (visible.at(0) == "Game Cover") {
-        fileItem->setText(6, " " + tr("No Cart"));
-        fileItem->setForeground(6, QBrush(Qt::gray));
-    } else {
-        fileItem->setText(5, " " + tr("No Cart"));
-        fileItem->setForeground(5, QBrush(Qt::gray));
-    }
-    addTopLevelItem(fileItem);
+    connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), parent, SLOT(showRomMenu(const QPoint &)));
 }
 
 
-void TableView::addToTableView(Rom *currentRom)
+QString TableView::getCurrentRomInfo(QString infoName)
 {
-    QStringList visible = SETTINGS.value("Table/columns", "Filename|Size").toString().split("|");
-
-    if (visible.join("") == "") //Otherwise no columns, so don't bother populating
-        return;
-
-    fileItem = new TreeWidgetItem(this);
-
-    //Filename for launching ROM
-    fileItem->setText(0, currentRom->fileName);
-
-    //Directory ROM is located in
-    fileItem->setText(1, currentRom->directory);
-
-    //GoodName or Internal Name for searching
-    if (currentRom->goodName == getTranslation("Unknown ROM") ||
-        currentRom->goodName == getTranslation("Requires catalog file"))
-        fileItem->setText(2, currentRom->internalName);
-    else
-        fileItem->setText(2, currentRom->goodName);
-
-    //MD5 for cache info
-    fileItem->setText(3, currentRom->romMD5.toLower());
-
-    //Zip file
-    fileItem->setText(4, currentRom->zipFile);
+    if (!currentIndex().isValid())
+        return "";
 
-    int i = 5, c = 0;
-    bool addImage = false;
+    return currentIndex().data(RomCollectionModel::getRoleFromName(infoName)).toString();
+}
 
-    foreach (QString current, visible)
-    {
-        QString text = getRomInfo(current, currentRom);
-        fileItem->setText(i, text);
-
-        if (current == "GoodName" || current == "Game Title") {
-            if (text == getTranslation("Unknown ROM") ||
-                text == getTranslation("Requires catalog file") ||
-                text == getTranslation("Not found")) {
-                fileItem->setForeground(i, QBrush(Qt::gray));
-                fileItem->setData(i, Qt::UserRole, "ZZZ"); //end of sorting
-            } else
-                fileItem->setData(i, Qt::UserRole, text);
-        }
 
-        if (current == "Size")
-            fileItem->setData(i, Qt::UserRole, currentRom->sortSize);
+RomFilterModel *TableView::getFilterModel()
+{
+    return filterModel;
+}
 
-        if (current == "Release Date")
-            fileItem->setData(i, Qt::UserRole, currentRom->sortDate);
 
-        if (current == "Game Cover") {
-            c = i;
-            addImage = true;
-        }
+bool TableView::hasSelectedRom()
+{
+    return currentIndex().isValid();
+}
 
-        QStringList center, right;
 
-        center << "MD5" << "CRC1" << "CRC2" << "Rumble" << "ESRB" << "Genre" << "Publisher" << "Developer";
-        right << "Size" << "Players" << "Save Type" << "Release Date" << "Rating";
+void TableView::highlightRow(const QModelIndex &current)
+{
+    if (current.isValid())
+        emit tableActive();
+}
 
-        if (center.contains(current))
-            fileItem->setTextAlignment(i, Qt::AlignHCenter | Qt::AlignVCenter);
-        else if (right.contains(current))
-            fileItem->setTextAlignment(i, Qt::AlignRight | Qt::AlignVCenter);
 
-        i++;
-    }
+void TableView::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter)
+        emit enterPressed();
+    else if (event->key() == Qt::Key_Down && !currentIndex().isValid() && tableModel->rowCount() > 0)
+        setCurrentIndex(tableModel->index(0, 0));
+    else
+        QTreeView::keyPressEvent(event);
+}
 
-    addTopLevelItem(fileItem);
 
+void TableView::requestCovers(int value)
+{
+    if (tableModel == NULL)
+        return;
 
-    if (currentRom->imageExists && addImage) {
-        QPixmap image(currentRom->image.scaled(getImageSize("Table"), Qt::KeepAspectRatio,
-                                              Qt::SmoothTransformation));
+    int coverColumn = tableModel->getColumns().indexOf(GameCoverField);
+    QModelIndex firstIndex = indexAt(QPoint(1, 1));
+    if (coverColumn == -1 || !firstIndex.isValid())
+        return;
 
-        QWidget *imageContainer = new QWidget(this);
-        QGridLayout *imageGrid = new QGridLayout(imageContainer);
-        QLabel *imageLabel = new QLabel(imageContainer);
+    QModelIndex last = indexAt(QPoint(1, viewport()->height() - 1));
+    int first = firstIndex.row();
+    int pageCount = (last.isValid() ? last.row() : tableModel->rowCount() - 1) - first + 1;
+    bool down = value >= lastScrollValue;
+    lastScrollValue = value;
 
-        imageLabel->setPixmap(image);
-        imageGrid->addWidget(imageLabel, 1, 1);
-        imageGrid->setColumnStretch(0, 1);
-        imageGrid->setColumnStretch(2, 1);
-        imageGrid->setRowStretch(0, 1);
-        imageGrid->setRowStretch(2, 1);
-        imageGrid->setContentsMargins(0,0,0,0);
+    //Rows on screen, then a page ahead; covers of rows scrolled past are dropped
+    CoverLoader::instance()->beginRequests();
 
-        imageContainer->setLayout(imageGrid);
+    int count = tableModel->rowCount();
+    for (int row = first; row < qMin(first + pageCount, count); row++)
+        delegate->requestCover(tableModel->index(row, coverColumn), CoverLoader::VisiblePriority);
 
-        setItemWidget(fileItem, c, imageContainer);
+    if (down) {
+        for (int row = first + pageCount; row < qMin(first + pageCount * 2, count); row++)
+            delegate->requestCover(tableModel->index(row, coverColumn), CoverLoader::PrefetchPriority);
+    } else {
+        for (int row = first - 1; row >= qMax(0, first - pageCount); row--)
+            delegate->requestCover(tableModel->index(row, coverColumn), CoverLoader::PrefetchPriority);
     }
-}
-
 
-QString TableView::getCurrentRomInfo(QString infoName)
-{
-    int index = getTableDataIndexFromName(infoName);
-    return QVariant(currentItem()->data(index, 0)).toString();
+    CoverLoader::instance()->endRequests();
 }
 
 
-bool TableView::hasSelectedRom()
-{
-    return currentItem() != NULL;
-}
-
-
-void TableView::keyPressEvent(QKeyEvent *event)
+void TableView::refreshView()
 {
-    if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter)
-        emit enterPressed();
-    else if (event->key() == Qt::Key_Down && selectedItems().count() == 0) {
-        setCurrentItem(topLevelItem(0));
-        emit tableActive();
-    } else if (event->key() == Qt::Key_Down  && selectedItems().count() == 1) {
-        int current = indexOfTopLevelItem(selectedItems().at(0));
-        if (current < topLevelItemCount() - 1)
-            setCurrentItem(topLevelItem(current + 1));
-    } else if (event->key() == Qt::Key_Up  && selectedItems().count() == 1) {
-        int current = indexOfTopLevelItem(selectedItems().at(0));
-        if (current > 0)
-            setCurrentItem(topLevelItem(current - 1));
-    } else
-        QTreeWidget::keyPressEvent(event);
+    delegate->updateSettings();
+    viewport()->update();
 }
 
 
 void TableView::resetView(bool imageUpdated)
 {
-    QStringList tableVisible = SETTINGS.value("Table/columns", "Filename|Size").toString().split("|");
-
-    QStringList translations;
-    foreach (QString header, tableVisible) translations << getTranslation(header);
-
-    int hidden = 5;
+    QStringList tableVisible = CACHED_SETTINGS.tableColumns;
+    QVector<RomFieldId> visible = getRomFieldIds(tableVisible);
 
-    saveColumnWidths();
+    //Widths of other columns would end up on the wrong fields
+    if (tableModel->getColumns() == visible)
+        saveColumnWidths();
     QStringList widths = SETTINGS.value("Table/width", "").toString().split("|");
 
-    headerLabels.clear();
-    headerLabels << "" << "" << "" << "" << "" << translations; //First 5 blank for hidden columns
-
-    //Remove Game Cover title for aesthetics
-    for (int i = 0; i < headerLabels.size(); i++)
-        if (headerLabels.at(i) == getTranslation("Game Cover")) headerLabels.replace(i, "");
-
-    setColumnCount(headerLabels.size());
-    setHeaderLabels(headerLabels);
-    headerView->setSortIndicatorShown(false);
+    tableModel->setColumns(visible);
+    delegate->updateSettings();
 
     int height = 0, width = 0;
-    if (tableVisible.contains("Game Cover")) {
+    if (visible.contains(GameCoverField)) {
         //Get optimal height/width for cover column
         height = getImageSize("Table").height() * 1.1;
         width = getImageSize("Table").width() * 1.2;
@@ -246,28 +184,23 @@ void TableView::resetView(bool imageUpdated)
     } else
         setStyleSheet("QTreeView { border: none; } QTreeView::item { height: 25px; }");
 
-    QStringList sort = SETTINGS.value("Table/sort", "").toString().split("|");
+    QStringList sort = CACHED_SETTINGS.tableSort.split("|");
     if (sort.size() == 2) {
         if (sort[1] == "descending")
-            headerView->setSortIndicator(tableVisible.indexOf(sort[0]) + hidden, Qt::DescendingOrder);
+            headerView->setSortIndicator(tableVisible.indexOf(sort[0]), Qt::DescendingOrder);
         else
-            headerView->setSortIndicator(tableVisible.indexOf(sort[0]) + hidden, Qt::AscendingOrder);
+            headerView->setSortIndicator(tableVisible.indexOf(sort[0]), Qt::AscendingOrder);
     }
 
-    setColumnHidden(0, true); //Hidden filename for launching emulator
-    setColumnHidden(1, true); //Hidden directory of ROM location
-    setColumnHidden(2, true); //Hidden goodname for searching
-    setColumnHidden(3, true); //Hidden md5 for cache info
-    setColumnHidden(4, true); //Hidden column for zip file
-
-    int i = hidden;
-    foreach (QString current, tableVisible)
+    for (int i = 0; i < visible.size(); i++)
     {
-        if (i == hidden) {
+        RomFieldId current = visible.at(i);
+
+        if (i == 0) {
             int c = i;
-            if (current == "Game Cover") c++; //If first column is game cover, use next column
+            if (current == GameCoverField) c++; //If first column is game cover, use next column
 
-            if (SETTINGS.value("Table/stretchfirstcolumn", "true") == "true")
+            if (CACHED_SETTINGS.tableStretchFirstColumn)
 #if QT_VERSION >= 0x050000
                 header()->setSectionResizeMode(c, QHeaderView::Stretch);
 #else
@@ -281,16 +214,14 @@ void TableView::resetView(bool imageUpdated)
 #endif
         }
 
-        if (widths.size() == tableVisible.size())
-            setColumnWidth(i, widths[i - hidden].toInt());
+        if (widths.size() == visible.size())
+            setColumnWidth(i, widths[i].toInt());
         else
             setColumnWidth(i, getDefaultWidth(current, width));
 
         //Overwrite saved value if switching image sizes
-        if (imageUpdated && current == "Game Cover")
+        if (imageUpdated && current == GameCoverField)
             setColumnWidth(i, width);
-
-        i++;
     }
 }
 
@@ -299,7 +230,7 @@ void TableView::saveColumnWidths()
 {
     QStringList widths;
 
-    for (int i = 5; i < columnCount(); i++)
+    for (int i = 0; i < tableModel->columnCount(); i++)
     {
         widths << QString::number(columnWidth(i));
     }
@@ -311,12 +242,24 @@ void TableView::saveColumnWidths()
 
 void TableView::saveSortOrder(int column, Qt::SortOrder order)
 {
-    QString columnName = headerLabels.value(column);
+    RomFieldId field = tableModel->getColumnField(column);
+    if (field == InvalidField)
+        return;
+
+    QString sort = getRomField(field).name;
 
     if (order == Qt::DescendingOrder)
-        SETTINGS.setValue("Table/sort", columnName + "|descending");
+        sort += "|descending";
     else
-        SETTINGS.setValue("Table/sort", columnName + "|ascending");
+        sort += "|ascending";
+
+    if (sort != CACHED_SETTINGS.tableSort) {
+        SettingsSnapshot settings = CACHED_SETTINGS;
+        settings.tableSort = sort;
+        SettingsStore::instance()->update(settings);
+
+        emit sortChanged();
+    }
 }
 
 
@@ -325,10 +268,9 @@ void TableView::saveTablePosition()
     positionx = horizontalScrollBar()->value();
     positiony = verticalScrollBar()->value();
 
-    if (selectedItems().count() > 0) {
-        int index = getTableDataIndexFromName("fileName");
-        savedTableRom = indexOfTopLevelItem(selectedItems().at(0));
-        savedTableRomFilename = QVariant(topLevelItem(savedTableRom)->data(index, 0)).toString();
+    if (currentIndex().isValid()) {
+        savedTableRom = currentIndex().row();
+        savedTableRomFilename = getCurrentRomInfo("fileName");
     } else {
         savedTableRom = -1;
         savedTableRomFilename = "";
@@ -336,18 +278,47 @@ void TableView::saveTablePosition()
 }
 
 
+void TableView::setCollectionModel(RomCollectionModel *model)
+{
+    this->model = model;
+
+    filterModel = new RomFilterModel(model, this);
+    tableModel = new RomTableModel(filterModel, this);
+    QTreeView::setModel(tableModel);
+
+    //The collection model does the sorting, the header only picks the field
+#if QT_VERSION >= 0x050000
+    headerView->setSectionsClickable(true);
+#else
+    headerView->setClickable(true);
+#endif
+    headerView->setSortIndicatorShown(true);
+
+    connect(headerView, SIGNAL(sortIndicatorChanged(int,Qt::SortOrder)),
+            this, SLOT(saveSortOrder(int,Qt::SortOrder)));
+    connect(selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)),
+            this, SLOT(highlightRow(QModelIndex)));
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(updateRows(QModelIndex, QModelIndex)));
+}
+
+
 void TableView::setTablePosition()
 {
     horizontalScrollBar()->setValue(positionx);
     verticalScrollBar()->setValue(positiony);
 
     //Restore selected ROM if it is in the same position
-    if (savedTableRom >= 0) {
-        int index = getTableDataIndexFromName("fileName");
-        QString checkFilename = QVariant(topLevelItem(savedTableRom)->data(index, 0)).toString();
-        if (savedTableRomFilename == checkFilename) {
-            setCurrentItem(topLevelItem(savedTableRom));
-            emit tableActive();
-        }
+    if (savedTableRom >= 0 && savedTableRom < tableModel->rowCount()) {
+        QModelIndex checkIndex = tableModel->index(savedTableRom, 0);
+        if (checkIndex.data(RomCollectionModel::FileNameRole).toString() == savedTableRomFilename)
+            setCurrentIndex(checkIndex);
     }
 }
+
+
+void TableView::updateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    //Covers are cached scaled, so drop the ones that may have been replaced
+    for (int row = topLeft.row(); row <= bottomRight.row(); row++)
+        delegate->clearCover(model->index(row).data(RomCollectionModel::MD5Role).toString());
+}
@@ -29,49 +29,67 @@
  *
  ***/
 
+
 #ifndef TABLEVIEW_H
 #define TABLEVIEW_H
 
-#include <QTreeWidget>
+#include <QModelIndex>
+#include <QTreeView>
 
-class TreeWidgetItem;
-struct Rom;
+class QHeaderView;
+class RomCollectionModel;
+class RomFilterModel;
+class RomTableModel;
+class TableDelegate;
 
 
-class TableView : public QTreeWidget
+// Table of the collection with the columns chosen in the settings.
+// Rows come from RomTableModel and only the ones on screen are painted,
+// covers included.  Clicking a header changes the sort of the collection
+// model instead of sorting the view.
+class TableView : public QTreeView
 {
     Q_OBJECT
 
 public:
     explicit TableView(QWidget *parent = 0);
-    void addNoCartRow();
-    void addToTableView(Rom *currentRom);
     QString getCurrentRomInfo(QString infoName);
+    RomFilterModel *getFilterModel();
     bool hasSelectedRom();
     void resetView(bool imageUpdated);
     void saveColumnWidths();
     void saveTablePosition();
+    void setCollectionModel(RomCollectionModel *model);
+
+public slots:
+    void refreshView();
 
 protected:
     void keyPressEvent(QKeyEvent *event);
 
 signals:
     void enterPressed();
+    void sortChanged();
     void tableActive();
 
 private:
     int positionx;
     int positiony;
+    int lastScrollValue;
     int savedTableRom;
     QString savedTableRomFilename;
-    QStringList headerLabels;
     QHeaderView *headerView;
-    QWidget *parent;
-    TreeWidgetItem *fileItem;
+    TableDelegate *delegate;
+    RomCollectionModel *model;
+    RomFilterModel *filterModel;
+    RomTableModel *tableModel;
 
 private slots:
+    void highlightRow(const QModelIndex &current);
+    void requestCovers(int value);
     void saveSortOrder(int column, Qt::SortOrder order);
     void setTablePosition();
+    void updateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight);
 
 };
 
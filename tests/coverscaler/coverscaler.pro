@@ -0,0 +1,14 @@
+QT       += core gui testlib
+
+TARGET = tst_coverscaler
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../src/roms
+
+SOURCES += tst_coverscaler.cpp \
+    ../../src/roms/coverscaler.cpp
+
+HEADERS += ../../src/roms/coverscaler.h
@@ -0,0 +1,179 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "coverscaler.h"
+
+#include <QtTest>
+
+#include <math.h>
+
+
+// Box art sized cover with an alpha channel and no pattern to line up with
+static QImage getCover(int width, int height)
+{
+    QImage image(width, height, QImage::Format_ARGB32);
+    quint32 seed = 1;
+
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++) {
+            seed = seed * 1103515245 + 12345;
+            image.setPixel(x, y, seed >> 8 | 0x80000000);
+        }
+
+    return image;
+}
+
+
+// What scaleCover() approximates: every target pixel is the mean of the
+// premultiplied source it covers, weighted by coverage, in floating point
+static QImage getAreaAverage(const QImage &image, const QSize &size)
+{
+    QImage source = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QImage target(size, QImage::Format_ARGB32_Premultiplied);
+    double scaleX = double(source.width()) / size.width();
+    double scaleY = double(source.height()) / size.height();
+
+    for (int y = 0; y < size.height(); y++)
+        for (int x = 0; x < size.width(); x++) {
+            double sums[4] = { 0, 0, 0, 0 };
+
+            for (int sy = int(y * scaleY); sy < ceil((y + 1) * scaleY); sy++) {
+                double coverY = qMin((y + 1) * scaleY, sy + 1.0) - qMax(y * scaleY, double(sy));
+
+                for (int sx = int(x * scaleX); sx < ceil((x + 1) * scaleX); sx++) {
+                    double cover = coverY * (qMin((x + 1) * scaleX, sx + 1.0) - qMax(x * scaleX, double(sx)));
+                    QRgb pixel = source.pixel(sx, sy);
+
+                    sums[0] += qAlpha(pixel) * cover;
+                    sums[1] += qRed(pixel) * cover;
+                    sums[2] += qGreen(pixel) * cover;
+                    sums[3] += qBlue(pixel) * cover;
+                }
+            }
+
+            double area = scaleX * scaleY;
+            target.setPixel(x, y, qRgba(qRound(sums[1] / area), qRound(sums[2] / area),
+                                        qRound(sums[3] / area), qRound(sums[0] / area)));
+        }
+
+    return target;
+}
+
+
+class TestCoverScaler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void areaAverage_data();
+    void areaAverage();
+    void enlarge();
+    void benchmark_data();
+    void benchmark();
+};
+
+
+void TestCoverScaler::areaAverage_data()
+{
+    QTest::addColumn<QSize>("source");
+    QTest::addColumn<QSize>("target");
+
+    QTest::newRow("box art") << QSize(317, 451) << QSize(140, 199);
+    QTest::newRow("halved") << QSize(200, 300) << QSize(100, 150);
+    QTest::newRow("one row") << QSize(64, 9) << QSize(7, 1);
+    QTest::newRow("same size") << QSize(40, 30) << QSize(40, 30);
+}
+
+
+void TestCoverScaler::areaAverage()
+{
+    QFETCH(QSize, source);
+    QFETCH(QSize, target);
+
+    QImage cover = getCover(source.width(), source.height());
+    QImage scaled = scaleCover(cover, target);
+    QImage expected = getAreaAverage(cover, target);
+
+    QCOMPARE(scaled.size(), target);
+    QCOMPARE(scaled.format(), QImage::Format_ARGB32_Premultiplied);
+
+    //Fixed point weights may round a channel one level off
+    for (int y = 0; y < target.height(); y++)
+        for (int x = 0; x < target.width(); x++) {
+            QRgb got = scaled.pixel(x, y);
+            QRgb want = expected.pixel(x, y);
+
+            QVERIFY2(qAbs(qAlpha(got) - qAlpha(want)) <= 1 && qAbs(qRed(got) - qRed(want)) <= 1 &&
+                     qAbs(qGreen(got) - qGreen(want)) <= 1 && qAbs(qBlue(got) - qBlue(want)) <= 1,
+                     qPrintable(QString("pixel %1,%2 is %3, expected %4").arg(x).arg(y)
+                                .arg(got, 8, 16, QChar('0')).arg(want, 8, 16, QChar('0'))));
+        }
+}
+
+
+void TestCoverScaler::enlarge()
+{
+    QImage scaled = scaleCover(getCover(20, 30), QSize(40, 60));
+
+    QCOMPARE(scaled.size(), QSize(40, 60));
+    QCOMPARE(scaled.format(), QImage::Format_ARGB32_Premultiplied);
+    QVERIFY(scaleCover(QImage(), QSize(40, 60)).isNull());
+}
+
+
+void TestCoverScaler::benchmark_data()
+{
+    QTest::addColumn<bool>("smooth");
+
+    QTest::newRow("scaleCover") << false;
+    QTest::newRow("QImage::scaled") << true;
+}
+
+
+void TestCoverScaler::benchmark()
+{
+    QFETCH(bool, smooth);
+
+    QImage cover = getCover(1000, 1400);
+    QSize size(140, 196);
+
+    QBENCHMARK {
+        if (smooth)
+            cover.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        else
+            scaleCover(cover, size);
+    }
+}
+
+
+QTEST_APPLESS_MAIN(TestCoverScaler)
+
+#include "tst_coverscaler.moc"
@@ -0,0 +1,14 @@
+QT       += core concurrent testlib
+QT       -= gui
+
+TARGET = tst_parallelsort
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../src/roms
+
+SOURCES += tst_parallelsort.cpp
+
+HEADERS += ../../src/roms/parallelsort.h
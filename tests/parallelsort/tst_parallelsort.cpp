@@ -0,0 +1,137 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "parallelsort.h"
+
+#include <QtTest>
+
+
+// Sorted on key only, so index shows whether equal keys kept their order
+struct Item {
+    QString key;
+    int index;
+};
+
+
+static bool lessThan(const Item &first, const Item &last)
+{
+    return first.key < last.key;
+}
+
+
+// A ROM list's worth of names with plenty of duplicates
+static QVector<Item> getItems(int count)
+{
+    QVector<Item> items(count);
+    quint32 seed = 1;
+
+    for (int i = 0; i < count; i++) {
+        seed = seed * 1103515245 + 12345;
+        items[i].key = QString("Game %1").arg((seed >> 16) % (count / 4 + 1));
+        items[i].index = i;
+    }
+
+    return items;
+}
+
+
+class TestParallelSort : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void stable_data();
+    void stable();
+    void benchmark_data();
+    void benchmark();
+};
+
+
+void TestParallelSort::stable_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("chunkSize");
+
+    QTest::newRow("empty") << 0 << 16;
+    QTest::newRow("one chunk") << 100 << 2048;
+    QTest::newRow("uneven chunks") << 1001 << 16;
+    QTest::newRow("many chunks") << 20000 << 64;
+}
+
+
+void TestParallelSort::stable()
+{
+    QFETCH(int, count);
+    QFETCH(int, chunkSize);
+
+    QVector<Item> expected = getItems(count);
+    QVector<Item> items = expected;
+
+    std::stable_sort(expected.begin(), expected.end(), lessThan);
+    parallelStableSort(items, lessThan, chunkSize);
+
+    QCOMPARE(items.size(), expected.size());
+    for (int i = 0; i < items.size(); i++) {
+        QCOMPARE(items[i].key, expected[i].key);
+        QCOMPARE(items[i].index, expected[i].index);
+    }
+}
+
+
+void TestParallelSort::benchmark_data()
+{
+    QTest::addColumn<bool>("parallel");
+
+    QTest::newRow("std::stable_sort") << false;
+    QTest::newRow("parallelStableSort") << true;
+}
+
+
+void TestParallelSort::benchmark()
+{
+    QFETCH(bool, parallel);
+
+    QVector<Item> source = getItems(50000);
+
+    QBENCHMARK {
+        QVector<Item> items = source;
+
+        if (parallel)
+            parallelStableSort(items, lessThan);
+        else
+            std::stable_sort(items.begin(), items.end(), lessThan);
+    }
+}
+
+
+QTEST_APPLESS_MAIN(TestParallelSort)
+
+#include "tst_parallelsort.moc"
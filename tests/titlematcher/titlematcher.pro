@@ -0,0 +1,17 @@
+QT       += core testlib
+QT       -= gui
+
+TARGET = tst_titlematcher
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../src/roms
+
+SOURCES += tst_titlematcher.cpp \
+    ../../src/roms/titlematcher.cpp
+
+HEADERS += ../../src/roms/titlematcher.h
+
+RESOURCES += titlematcher.qrc
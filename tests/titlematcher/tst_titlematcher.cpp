@@ -0,0 +1,140 @@
+/***
+ * Copyright (c) 2019, Robert Alm Nilsson
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the organization nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+
+#include "titlematcher.h"
+
+#include <QtTest>
+
+
+class TestTitleMatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void alias();
+    void key_data();
+    void key();
+    void match_data();
+    void match();
+    void matchFirstInserted();
+};
+
+
+void TestTitleMatcher::alias()
+{
+    QCOMPARE(TitleMatcher::getAlias("GOLDENEYE"), QString("GoldenEye 007"));
+    QCOMPARE(TitleMatcher::getAlias("Pokemon Snap (U) [!]"), QString("Pokémon Snap"));
+    QCOMPARE(TitleMatcher::getAlias("Wave Race 64"), QString("Wave Race 64"));
+}
+
+
+void TestTitleMatcher::key_data()
+{
+    QTest::addColumn<QString>("title");
+    QTest::addColumn<QString>("key");
+
+    QTest::newRow("goodname") << "Legend of Zelda, The - Ocarina of Time (U) [!]"
+                              << "legend of zelda ocarina of time";
+    QTest::newRow("title") << "The Legend of Zelda: Ocarina of Time"
+                           << "legend of zelda ocarina of time";
+    QTest::newRow("accents") << "Pokémon Snap" << "pokemon snap";
+    QTest::newRow("numeral") << "Mario Party II" << "mario party 2";
+    QTest::newRow("ampersand") << "Banjo & Kazooie" << "banjo and kazooie";
+}
+
+
+void TestTitleMatcher::key()
+{
+    QFETCH(QString, title);
+    QFETCH(QString, key);
+
+    QCOMPARE(TitleMatcher::getKey(title), key);
+}
+
+
+void TestTitleMatcher::match_data()
+{
+    QTest::addColumn<QString>("title");
+    QTest::addColumn<int>("id");
+
+    QTest::newRow("goodname") << "Star Wars - Shadows of the Empire (U) [!]" << 1;
+    QTest::newRow("subtitle left out") << "Rogue Squadron" << 0;
+    QTest::newRow("internal name") << "STAR WARS ROGUE" << 0;
+    QTest::newRow("numeral") << "Mario Party II" << 4;
+    QTest::newRow("sequel") << "Mario Party 3 (U)" << 5;
+    QTest::newRow("other game") << "Banjo-Kazooie" << -1;
+    QTest::newRow("nothing close") << "Superman" << -1;
+}
+
+
+void TestTitleMatcher::match()
+{
+    QFETCH(QString, title);
+    QFETCH(int, id);
+
+    TitleMatcher matcher;
+    matcher.insert(0, "Star Wars: Rogue Squadron");
+    matcher.insert(1, "Star Wars: Shadows of the Empire");
+    matcher.insert(2, "Star Wars Episode I: Racer");
+    matcher.insert(3, "Mario Party");
+    matcher.insert(4, "Mario Party 2");
+    matcher.insert(5, "Mario Party 3");
+    matcher.insert(6, "Banjo-Tooie");
+
+    double score = -1;
+    QCOMPARE(matcher.match(title, &score), id);
+
+    if (id == -1)
+        QCOMPARE(score, 0.0);
+    else
+        QVERIFY(score > 0 && score <= 1);
+}
+
+
+void TestTitleMatcher::matchFirstInserted()
+{
+    TitleMatcher matcher;
+    matcher.insert(5, "F-Zero X");
+    matcher.insert(7, "F-Zero X");
+
+    QCOMPARE(matcher.match("F-ZERO X (U) [!]"), 5);
+
+    //A different sequel number never matches, even as the only title
+    TitleMatcher sequels;
+    sequels.insert(0, "Mario Party 2");
+
+    QCOMPARE(sequels.match("Mario Party 3"), -1);
+}
+
+
+QTEST_APPLESS_MAIN(TestTitleMatcher)
+
+#include "tst_titlematcher.moc"